@@ -0,0 +1,146 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Groups entities that share the same component mask
+//                (archetype) into fixed size chunks, so that systems
+//                can skip over entities they are not interested in
+//                without testing each entity's mask.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "Archetype.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+const size_t ArchetypeIndex::kNotIndexed = std::numeric_limits<size_t>::max();
+
+void* ArchetypeChunk::operator new(size_t size)
+{
+#ifdef _MSC_VER
+	void* ptr = _aligned_malloc(size, alignof(ArchetypeChunk));
+#else
+	void* ptr = nullptr;
+	if (posix_memalign(&ptr, alignof(ArchetypeChunk), size) != 0)
+		ptr = nullptr;
+#endif
+	if (!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void ArchetypeChunk::operator delete(void* ptr)
+{
+#ifdef _MSC_VER
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+void ArchetypeIndex::setComponentMask(size_t entityID, size_t componentMask)
+{
+	if (entityID >= m_locations.size())
+		m_locations.resize(entityID + 1, Location{ kNotIndexed, 0, 0 });
+
+	// Nothing to do if the entity is already in the right archetype
+	Location& location = m_locations[entityID];
+	if (location.archetype != kNotIndexed
+	 && m_archetypes[location.archetype].componentMask == componentMask)
+		return;
+
+	remove(entityID);
+	append(entityID, getArchetype(componentMask));
+}
+
+void ArchetypeIndex::setComponentMask(const size_t* entityIDs, size_t count, size_t componentMask)
+{
+	size_t maxEntityID = 0;
+	for (size_t i = 0; i < count; ++i)
+		maxEntityID = std::max(maxEntityID, entityIDs[i]);
+	if (count > 0 && maxEntityID >= m_locations.size())
+		m_locations.resize(maxEntityID + 1, Location{ kNotIndexed, 0, 0 });
+
+	size_t archetypeIdx = getArchetype(componentMask);
+	for (size_t i = 0; i < count; ++i) {
+		if (m_locations[entityIDs[i]].archetype == archetypeIdx)
+			continue;
+		remove(entityIDs[i]);
+		append(entityIDs[i], archetypeIdx);
+	}
+}
+
+void ArchetypeIndex::remove(size_t entityID)
+{
+	if (entityID >= m_locations.size() || m_locations[entityID].archetype == kNotIndexed)
+		return;
+
+	// Fill the hole with the last entity in the archetype
+	Location location = m_locations[entityID];
+	Archetype& archetype = m_archetypes[location.archetype];
+	ArchetypeChunk& lastChunk = *archetype.chunks.back();
+	size_t movedEntityID = lastChunk.entities[lastChunk.count - 1];
+	archetype.chunks[location.chunk]->entities[location.slot] = movedEntityID;
+	m_locations[movedEntityID].chunk = location.chunk;
+	m_locations[movedEntityID].slot = location.slot;
+
+	--lastChunk.count;
+	if (lastChunk.count == 0)
+		archetype.chunks.pop_back();
+
+	m_locations[entityID].archetype = kNotIndexed;
+}
+
+void ArchetypeIndex::getMatchingChunks(size_t componentMask, std::vector<const ArchetypeChunk*>& outChunks) const
+{
+	outChunks.clear();
+	for (const Archetype& archetype : m_archetypes) {
+		if ((archetype.componentMask & componentMask) != componentMask)
+			continue;
+
+		for (const auto& chunk : archetype.chunks)
+			outChunks.push_back(chunk.get());
+	}
+}
+
+const std::vector<Archetype>& ArchetypeIndex::getArchetypes() const
+{
+	return m_archetypes;
+}
+
+void ArchetypeIndex::append(size_t entityID, size_t archetypeIdx)
+{
+	Archetype& archetype = m_archetypes[archetypeIdx];
+	if (archetype.chunks.empty() || archetype.chunks.back()->count == ArchetypeChunk::kCapacity) {
+		archetype.chunks.emplace_back(new ArchetypeChunk);
+		archetype.chunks.back()->count = 0;
+	}
+
+	ArchetypeChunk& chunk = *archetype.chunks.back();
+	chunk.entities[chunk.count] = entityID;
+	m_locations[entityID] = Location{ archetypeIdx, archetype.chunks.size() - 1, chunk.count };
+	++chunk.count;
+}
+
+size_t ArchetypeIndex::getArchetype(size_t componentMask)
+{
+	auto it = m_archetypeLookup.find(componentMask);
+	if (it != m_archetypeLookup.end())
+		return it->second;
+
+	m_archetypes.push_back(Archetype{ componentMask, {} });
+	m_archetypeLookup.insert(std::make_pair(componentMask, m_archetypes.size() - 1));
+	return m_archetypes.size() - 1;
+}
@@ -0,0 +1,81 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Groups entities that share the same component mask
+//                (archetype) into fixed size chunks, so that systems
+//                can skip over entities they are not interested in
+//                without testing each entity's mask.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// A fixed size, cache line aligned block of IDs for entities with the same component mask.
+struct alignas(64) ArchetypeChunk {
+	// Sized so that a chunk fills exactly 8 cache lines
+	static const size_t kCapacity = 63;
+
+	size_t count;
+	size_t entities[kCapacity];
+
+	// Chunks are over aligned, so they need to be allocated from aligned memory
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr);
+};
+
+// All of the entities that have a particular component mask
+struct Archetype {
+	size_t componentMask;
+	std::vector<std::unique_ptr<ArchetypeChunk>> chunks;
+};
+
+class ArchetypeIndex {
+public:
+	// Moves the entity into the archetype matching its new component mask.
+	// Entities that are not in the index yet are added to it.
+	// Runs in O(1) time.
+	void setComponentMask(size_t entityID, size_t componentMask);
+
+	// Moves many entities into the archetype matching the same new component mask,
+	// looking the archetype up once for the whole batch.
+	void setComponentMask(const size_t* entityIDs, size_t count, size_t componentMask);
+
+	// Removes the entity from the index in O(1) time.
+	void remove(size_t entityID);
+
+	// Gets all chunks containing entities that have at least the components in the mask.
+	void getMatchingChunks(size_t componentMask, std::vector<const ArchetypeChunk*>& outChunks) const;
+
+	// Returns all archetypes that have been encountered
+	const std::vector<Archetype>& getArchetypes() const;
+
+private:
+	// The location of an entity's ID inside the index
+	struct Location {
+		size_t archetype;
+		size_t chunk;
+		size_t slot;
+	};
+
+	// Returns the index of the archetype for the mask, creating it if necessary
+	size_t getArchetype(size_t componentMask);
+
+	// Appends an entity that is not in the index to the last chunk of an archetype
+	void append(size_t entityID, size_t archetypeIdx);
+
+	static const size_t kNotIndexed;
+
+	std::vector<Archetype> m_archetypes;
+	std::unordered_map<size_t, size_t> m_archetypeLookup;
+	std::vector<Location> m_locations;
+};
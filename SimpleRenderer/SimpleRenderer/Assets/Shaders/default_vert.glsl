@@ -4,26 +4,54 @@ layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec3 inNormal;
 layout (location = 2) in vec2 inTexCoord;
 
-layout (std140) uniform Uniforms {
-    mat4 model;
+// The entity ID of the instance, read from the draw's base instance onwards
+layout (location = 3) in uint inEntityID;
+
+layout (std140) uniform FrameUniforms {
     mat4 view;
     mat4 projection;
+    mat4 viewProjection;
 	vec4 cameraPos;
-} u;
+	float time;
+} f;
+
+struct ObjectData {
+    mat4 model;
+    mat3 normalMatrix;
+};
+
+struct ShaderParamsData {
+	float metallicness;
+	float glossiness;
+};
+
+// Every entity's data, indexed by entity ID
+layout (std430) readonly buffer Objects {
+    ObjectData objects[];
+};
+
+layout (std430) readonly buffer ShaderParams {
+    ShaderParamsData shaderParams[];
+};
 
 out VertexData {
     vec3 normal;
     vec2 texCoord;
 	vec3 viewDir;
+	flat float metallicness;
+	flat float glossiness;
 } o;
 
 void main()
 {
+	ObjectData u = objects[inEntityID];
 	vec3 worldPos = (u.model * vec4(inPosition, 1)).xyz;
 
-    o.normal = (u.model * vec4(inNormal, 0)).xyz; // TODO: Do inverse transpose
+    o.normal = u.normalMatrix * inNormal;
     o.texCoord = inTexCoord;
-	o.viewDir = (u.cameraPos.xyz - worldPos).xyz;
+	o.viewDir = (f.cameraPos.xyz - worldPos).xyz;
+	o.metallicness = shaderParams[inEntityID].metallicness;
+	o.glossiness = shaderParams[inEntityID].glossiness;
 
-    gl_Position = u.projection * u.view * vec4(worldPos, 1);
+    gl_Position = f.viewProjection * vec4(worldPos, 1);
 }
@@ -4,6 +4,8 @@ in VertexData {
 	vec3 normal;
 	vec2 texCoord;
 	vec3 viewDir;
+	flat float metallicness;
+	flat float glossiness;
 } i;
 
 out vec4 outColor;
@@ -2,12 +2,13 @@
 
 layout (location = 0) in vec3 inPosition;
 
-layout (std140) uniform Uniforms {
-    mat4 model;
+layout (std140) uniform FrameUniforms {
     mat4 view;
     mat4 projection;
+    mat4 viewProjection;
 	vec4 cameraPos;
-} u;
+	float time;
+} f;
 
 out VertexData {
     vec3 textureDir;
@@ -15,8 +16,8 @@ out VertexData {
 
 void main()
 {
-	mat4 view = u.view;
+	mat4 view = f.view;
 	view[3] = vec4(0, 0, 0, 1);
 	o.textureDir = inPosition;
-	gl_Position = (u.projection * view * vec4(inPosition, 1.0)).xyww;
+	gl_Position = (f.projection * view * vec4(inPosition, 1.0)).xyww;
 }
@@ -4,13 +4,10 @@ in VertexData {
 	vec3 normal;
 	vec2 texCoord;
 	vec3 viewDir;
+	flat float metallicness;
+	flat float glossiness;
 } i;
 
-layout (std140) uniform ShaderParams {
-	float metallicness;
-	float glossiness;
-} p;
-
 out vec4 outColor;
 
 uniform sampler2D sampler;
@@ -46,11 +43,11 @@ void main(void)
 	
 	//vec3 LiRefl = texture(environmentSampler, LiReflDir).rgb;
 	
-	float specPow = p.glossiness;
+	float specPow = i.glossiness;
 	float specNorm = (specPow + 4) * (specPow + 2) / (8 * PI * (specPow + pow(2, -specPow / 2)));
-	vec3 BRDFdiff = (1 - p.metallicness) * kDiffNorm * color;
-	vec3 BRDFspec = p.metallicness * specNorm * color * pow(ndoth, specPow);
-	// vec3 BRDFrefl = p.metallicness * specNorm * color; // n dot hrefl is always 1
+	vec3 BRDFdiff = (1 - i.metallicness) * kDiffNorm * color;
+	vec3 BRDFspec = i.metallicness * specNorm * color * pow(ndoth, specPow);
+	// vec3 BRDFrefl = i.metallicness * specNorm * color; // n dot hrefl is always 1
 	vec3 BRDFdirect = BRDFdiff + BRDFspec;
 
 	//vec3 LrRefl = LiRefl * BRDFrefl * ndotRl;
@@ -4,13 +4,10 @@ in VertexData {
 	vec3 normal;
 	vec2 texCoord;
 	vec3 viewDir;
+	flat float metallicness;
+	flat float glossiness;
 } i;
 
-layout (std140) uniform ShaderParams {
-	float metallicness;
-	float glossiness;
-} p;
-
 out vec4 outColor;
 
 uniform sampler2D sampler;
@@ -117,17 +114,17 @@ void main(void)
 	vec3 LiReflTangent = normalize(cross(LiReflDir, LiReflBiTangent));
 	float rnd = snoise(i.texCoord);
 	float rnd2 = snoise(i.texCoord + 1);
-	LiReflDir = normalize(LiReflDir + 1 / p.glossiness * (rnd * LiReflTangent + rnd2 * LiReflBiTangent));
+	LiReflDir = normalize(LiReflDir + 1 / i.glossiness * (rnd * LiReflTangent + rnd2 * LiReflBiTangent));
 	vec3 LiRefl = texture(environmentSampler, LiReflDir).rgb;
 	vec3 LiReflHalfVec = normalize(LiReflDir + viewDir);
 	float ndotRl = clamp(dot(LiReflDir, normal), 0, 1);
 	float ndotRh = clamp(dot(normal, LiReflHalfVec), 0, 1);
 	
-	float specPow = p.glossiness;
+	float specPow = i.glossiness;
 	float specNorm = (specPow + 4) * (specPow + 2) / (8 * PI * (specPow + pow(2, -specPow / 2)));
-	vec3 BRDFdiff = (1 - p.metallicness) *  kDiffNorm * color;
-	vec3 BRDFspec = p.metallicness * specNorm * color * pow(ndoth, specPow);
-	vec3 BRDFrefl = p.metallicness * specNorm * color * pow(ndotRh, specPow);
+	vec3 BRDFdiff = (1 - i.metallicness) *  kDiffNorm * color;
+	vec3 BRDFspec = i.metallicness * specNorm * color * pow(ndoth, specPow);
+	vec3 BRDFrefl = i.metallicness * specNorm * color * pow(ndotRh, specPow);
 	vec3 BRDFdirect = BRDFdiff + BRDFspec;
 
 	vec3 LrRefl = LiRefl * BRDFrefl * ndotRl;
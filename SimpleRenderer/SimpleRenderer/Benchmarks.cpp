@@ -0,0 +1,172 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Microbenchmarks for performance critical code.
+//                Run from the command line, results are printed to
+//                standard output.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "Benchmarks.h"
+
+#include "CpuFeatures.h"
+#include "GameplayLogicSystem.h"
+#include "JobSystem.h"
+#include "TransformMath.h"
+#include "TransformStorage.h"
+#include "Utils.h"
+
+#include <glm\glm.hpp>
+#include <glm\gtc\matrix_transform.hpp>
+#include <glm\gtc\quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+	// Returns the average time in seconds taken to run func
+	double timeIterations(size_t numIterations, const std::function<void()>& func)
+	{
+		func(); // Warm up caches
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < numIterations; ++i)
+			func();
+		auto end = std::chrono::high_resolution_clock::now();
+
+		return std::chrono::duration<double>(end - start).count() / numIterations;
+	}
+
+	void printResult(const char* name, double seconds, size_t numRotations, double baselineSeconds)
+	{
+		std::cout << std::left << std::setw(12) << name
+		          << std::right << std::setw(10) << std::fixed << std::setprecision(2) 
+		          << numRotations / seconds / 1e6 << " M rotations/s"
+		          << std::setw(10) << baselineSeconds / seconds << "x" << std::endl;
+	}
+}
+
+void Benchmarks::runSpinBenchmark(size_t numRotations, size_t numIterations)
+{
+	const float kAngle = 0.01f;
+
+	// Random unit rotations and axes
+	std::vector<glm::quat> initialRotations(numRotations);
+	std::vector<glm::vec3> axes(numRotations);
+	for (size_t i = 0; i < numRotations; ++i) {
+		glm::vec3 axis = glm::normalize(glm::vec3{ randomReal(-1.0f, 1.0f), randomReal(-1.0f, 1.0f), randomReal(-1.0f, 1.0f) } + glm::vec3{ 0, 0, 0.001f });
+		initialRotations[i] = glm::angleAxis(randomReal(0.0f, 6.28f), axis);
+		axes[i] = glm::normalize(glm::vec3{ randomReal(-1.0f, 1.0f), randomReal(-1.0f, 1.0f), randomReal(-1.0f, 1.0f) } + glm::vec3{ 0, 0.001f, 0 });
+	}
+
+	std::cout << "Spinning " << numRotations << " rotations, " << numIterations << " iterations" << std::endl;
+	std::cout << "CPU supports " << CpuFeatures::getSimdLevelName(CpuFeatures::getSimdLevel()) << std::endl;
+
+	// The rotations every path should end up with, timeIterations runs each path once more to warm up
+	std::vector<glm::quat> expectedRotations = initialRotations;
+	for (size_t iteration = 0; iteration < numIterations + 1; ++iteration) {
+		for (size_t i = 0; i < numRotations; ++i)
+			expectedRotations[i] = glm::normalize(expectedRotations[i] * glm::angleAxis(kAngle, axes[i]));
+	}
+	auto printMaxError = [&](const std::function<glm::quat(size_t)>& getRotation) {
+		float maxError = 0;
+		for (size_t i = 0; i < numRotations; ++i) {
+			// q and -q are the same rotation
+			glm::quat rotation = getRotation(i);
+			float sign = (glm::dot(rotation, expectedRotations[i]) < 0) ? -1.0f : 1.0f;
+			const glm::quat& expected = expectedRotations[i];
+			maxError = std::max({ maxError,
+			                      std::abs(sign * rotation.x - expected.x), std::abs(sign * rotation.y - expected.y),
+			                      std::abs(sign * rotation.z - expected.z), std::abs(sign * rotation.w - expected.w) });
+		}
+		std::cout << "            max difference from glm: " << std::scientific << maxError << std::endl;
+	};
+
+	// Baseline: one matrix at a time with glm::rotate, as the gameplay system used to do
+	std::vector<glm::mat4> matrices(numRotations);
+	for (size_t i = 0; i < numRotations; ++i)
+		matrices[i] = glm::translate(glm::mat4{ 1 }, glm::vec3{ static_cast<float>(i), 0, 0 }) * glm::mat4_cast(initialRotations[i]);
+	double baselineSeconds = timeIterations(numIterations, [&]() {
+		for (size_t i = 0; i < numRotations; ++i) {
+			glm::mat4& transform = matrices[i];
+			glm::vec3 pos = transform[3];
+			transform[3] = { 0, 0, 0, 1 }; // Remove displacement temporarily
+			transform = glm::rotate(transform, kAngle, axes[i]);
+			transform[3] = glm::vec4{ pos, 1 }; // Add displacement back in
+		}
+	});
+	printResult("glm mat4", baselineSeconds, numRotations, baselineSeconds);
+	printMaxError([&](size_t i) { return glm::normalize(glm::quat_cast(glm::mat3{ matrices[i] })); });
+
+	// Kernels work on one array per float
+	std::vector<float> axisX(numRotations);
+	std::vector<float> axisY(numRotations);
+	std::vector<float> axisZ(numRotations);
+	for (size_t i = 0; i < numRotations; ++i) {
+		axisX[i] = axes[i].x;
+		axisY[i] = axes[i].y;
+		axisZ[i] = axes[i].z;
+	}
+
+	for (int level = SIMD_SCALAR; level <= CpuFeatures::getSimdLevel(); ++level) {
+		SimdLevel simdLevel = static_cast<SimdLevel>(level);
+
+		std::vector<float> rotationX(numRotations);
+		std::vector<float> rotationY(numRotations);
+		std::vector<float> rotationZ(numRotations);
+		std::vector<float> rotationW(numRotations);
+		for (size_t i = 0; i < numRotations; ++i) {
+			rotationX[i] = initialRotations[i].x;
+			rotationY[i] = initialRotations[i].y;
+			rotationZ[i] = initialRotations[i].z;
+			rotationW[i] = initialRotations[i].w;
+		}
+
+		TransformMath::QuatArrays rotations{ rotationX.data(), rotationY.data(), rotationZ.data(), rotationW.data() };
+		TransformMath::Vec3Arrays axisArrays{ axisX.data(), axisY.data(), axisZ.data() };
+		double seconds = timeIterations(numIterations, [&]() {
+			TransformMath::spinRotations(rotations, axisArrays, kAngle, numRotations, simdLevel);
+		});
+		printResult(CpuFeatures::getSimdLevelName(simdLevel), seconds, numRotations, baselineSeconds);
+		printMaxError([&](size_t i) { return glm::quat{ rotationW[i], rotationX[i], rotationY[i], rotationZ[i] }; });
+	}
+
+	// The path the gameplay system runs: the kernel straight on the transform storage,
+	// split across the job system. The world transforms are then rebuilt from the
+	// spun rotations, which the old path didn't need to do.
+	JobSystem jobSystem;
+	auto runStorageBenchmark = [&](const char* name, bool updateWorldTransforms) {
+		TransformStorage transforms;
+		transforms.reserve(numRotations);
+		for (size_t entityID = 0; entityID < numRotations; ++entityID) {
+			transforms.emplace(entityID);
+			transforms.setPosition(entityID, glm::vec3{ static_cast<float>(entityID), 0, 0 });
+			transforms.setRotation(entityID, initialRotations[entityID]);
+			transforms.setSpinAxis(entityID, axes[entityID]);
+		}
+		transforms.updateWorldTransforms();
+
+		double seconds = timeIterations(numIterations, [&]() {
+			jobSystem.parallelFor(transforms.size(), GameplayLogicSystem::kGrainSize, [&transforms, kAngle](size_t begin, size_t end) {
+				transforms.spin(kAngle, begin, end - begin);
+			});
+			if (updateWorldTransforms)
+				transforms.updateWorldTransforms();
+		});
+		printResult(name, seconds, numRotations, baselineSeconds);
+		printMaxError([&](size_t i) { return transforms.getRotation(i); });
+	};
+	runStorageBenchmark("spin", false);
+	runStorageBenchmark("spin+world", true);
+}
@@ -0,0 +1,26 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Microbenchmarks for performance critical code.
+//                Run from the command line, results are printed to
+//                standard output.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include <cstddef>
+
+namespace Benchmarks {
+	// Compares the throughput of spinning transforms one matrix at a time with
+	// glm::rotate, as the gameplay system used to, against each version of the
+	// SIMD spin kernel supported by the CPU and against TransformStorage::spin,
+	// which is what the gameplay system runs now.
+	void runSpinBenchmark(size_t numRotations = 1 << 16, size_t numIterations = 200);
+}
@@ -0,0 +1,94 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Records structural changes to the scene so they can be
+//                applied when no system is iterating over the entities.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "CommandBuffer.h"
+
+#include "SceneUtils.h"
+
+CommandBuffer::CommandBuffer(Scene& scene)
+	: m_scene{ scene }
+{
+}
+
+void CommandBuffer::spawn(size_t componentMask, SpawnFunc onSpawn)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_commands.push_back({ COMMAND_SPAWN, EntityHandle{}, componentMask, m_spawnFuncs.size() });
+	m_spawnFuncs.push_back(std::move(onSpawn));
+}
+
+void CommandBuffer::destroy(const EntityHandle& entity)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_commands.push_back({ COMMAND_DESTROY, entity, COMPONENT_NONE, 0 });
+}
+
+void CommandBuffer::addComponents(const EntityHandle& entity, size_t components)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_commands.push_back({ COMMAND_ADD_COMPONENTS, entity, components, 0 });
+}
+
+void CommandBuffer::removeComponents(const EntityHandle& entity, size_t components)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_commands.push_back({ COMMAND_REMOVE_COMPONENTS, entity, components, 0 });
+}
+
+void CommandBuffer::flush()
+{
+	// Take the recorded commands, so that commands recorded by spawn
+	// callbacks are applied on the next flush
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_flushCommands.swap(m_commands);
+		m_flushSpawnFuncs.swap(m_spawnFuncs);
+	}
+
+	// Allocate every spawned entity at once
+	m_spawnedEntities.clear();
+	SceneUtils::createEntities(m_scene, m_flushSpawnFuncs.size(), m_spawnedEntities);
+
+	for (const Command& command : m_flushCommands) {
+		if (command.type == COMMAND_SPAWN) {
+			size_t entityID = m_spawnedEntities[command.spawnIndex];
+			SceneUtils::setComponentMask(m_scene, entityID, command.components);
+			const SpawnFunc& onSpawn = m_flushSpawnFuncs[command.spawnIndex];
+			if (onSpawn)
+				onSpawn(m_scene, entityID);
+			continue;
+		}
+
+		size_t entityID;
+		if (!SceneUtils::resolveHandle(m_scene, command.entity, entityID))
+			continue;
+
+		switch (command.type) {
+		case COMMAND_DESTROY:
+			SceneUtils::destroyEntity(m_scene, entityID);
+			break;
+		case COMMAND_ADD_COMPONENTS:
+			SceneUtils::addComponents(m_scene, entityID, command.components);
+			break;
+		case COMMAND_REMOVE_COMPONENTS:
+			SceneUtils::removeComponents(m_scene, entityID, command.components);
+			break;
+		default:
+			break;
+		}
+	}
+
+	m_flushCommands.clear();
+	m_flushSpawnFuncs.clear();
+}
@@ -0,0 +1,80 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Records structural changes to the scene (creating and
+//                destroying entities, adding and removing components)
+//                so they can be applied at a point in the frame where
+//                no system is iterating over the entities.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include "Scene.h"
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class CommandBuffer {
+public:
+	// Called with each spawned entity once its components have been added,
+	// so that the component data can be filled in
+	using SpawnFunc = std::function<void(Scene&, size_t entityID)>;
+
+	explicit CommandBuffer(Scene& scene);
+	CommandBuffer(const CommandBuffer&) = delete;
+	CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+	// Records the creation of an entity with the specified components.
+	// The entity's ID is only known once the buffer is flushed, it is passed to onSpawn.
+	void spawn(size_t componentMask, SpawnFunc onSpawn = nullptr);
+
+	// Records the destruction of an entity
+	void destroy(const EntityHandle& entity);
+
+	// Records enabling components on an entity
+	void addComponents(const EntityHandle& entity, size_t components);
+
+	// Records disabling components on an entity
+	void removeComponents(const EntityHandle& entity, size_t components);
+
+	// Applies the recorded commands in the order they were recorded, then clears the buffer.
+	// Commands on entities that have been destroyed by the time they are applied are skipped.
+	// IDs for all spawned entities are allocated in a single batch.
+	// Must be called while no systems are running.
+	void flush();
+
+private:
+	enum CommandType {
+		COMMAND_SPAWN,
+		COMMAND_DESTROY,
+		COMMAND_ADD_COMPONENTS,
+		COMMAND_REMOVE_COMPONENTS
+	};
+
+	struct Command {
+		CommandType type;
+		EntityHandle entity; // Unused for spawns
+		size_t components;
+		size_t spawnIndex; // Index into m_spawnFuncs, only used for spawns
+	};
+
+	Scene& m_scene;
+
+	// Recording is safe from any thread
+	std::mutex m_mutex;
+	std::vector<Command> m_commands;
+	std::vector<SpawnFunc> m_spawnFuncs;
+
+	// Reused between flushes to avoid reallocating
+	std::vector<Command> m_flushCommands;
+	std::vector<SpawnFunc> m_flushSpawnFuncs;
+	std::vector<size_t> m_spawnedEntities;
+};
@@ -0,0 +1,100 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Detects which SIMD instruction sets the CPU supports,
+//                so that the fastest version of a kernel can be chosen
+//                at runtime.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "CpuFeatures.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_FEATURES_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#ifdef CPU_FEATURES_X86
+namespace {
+	// Gets the CPUID registers (eax, ebx, ecx, edx) for a leaf and subleaf
+	void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int outRegisters[4])
+	{
+#ifdef _MSC_VER
+		int registers[4];
+		__cpuidex(registers, static_cast<int>(leaf), static_cast<int>(subleaf));
+		for (int i = 0; i < 4; ++i)
+			outRegisters[i] = static_cast<unsigned int>(registers[i]);
+#else
+		__cpuid_count(leaf, subleaf, outRegisters[0], outRegisters[1], outRegisters[2], outRegisters[3]);
+#endif
+	}
+
+	// Returns the OS enabled register state (XCR0)
+	unsigned long long getEnabledRegisterState()
+	{
+#ifdef _MSC_VER
+		return _xgetbv(0);
+#else
+		unsigned int eax;
+		unsigned int edx;
+		__asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+	}
+
+	SimdLevel detectSimdLevel()
+	{
+		unsigned int registers[4];
+		cpuid(0, 0, registers);
+		unsigned int maxLeaf = registers[0];
+
+		cpuid(1, 0, registers);
+		bool hasSSE2 = (registers[3] & (1u << 26)) != 0;
+		bool hasOSXSAVE = (registers[2] & (1u << 27)) != 0;
+		bool hasAVX = (registers[2] & (1u << 28)) != 0;
+		if (!hasSSE2)
+			return SIMD_SCALAR;
+
+		// AVX registers can only be used if the OS saves them on context switches
+		const unsigned long long kXmmYmmState = 0x6;
+		if (!hasOSXSAVE || !hasAVX || (getEnabledRegisterState() & kXmmYmmState) != kXmmYmmState || maxLeaf < 7)
+			return SIMD_SSE;
+
+		cpuid(7, 0, registers);
+		bool hasAVX2 = (registers[1] & (1u << 5)) != 0;
+		return hasAVX2 ? SIMD_AVX2 : SIMD_SSE;
+	}
+}
+#endif
+
+SimdLevel CpuFeatures::getSimdLevel()
+{
+#ifdef CPU_FEATURES_X86
+	static const SimdLevel s_simdLevel = detectSimdLevel();
+	return s_simdLevel;
+#else
+	return SIMD_SCALAR;
+#endif
+}
+
+const char* CpuFeatures::getSimdLevelName(SimdLevel level)
+{
+	switch (level) {
+	case SIMD_AVX2:
+		return "AVX2";
+	case SIMD_SSE:
+		return "SSE2";
+	default:
+		return "Scalar";
+	}
+}
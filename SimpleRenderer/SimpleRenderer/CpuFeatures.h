@@ -0,0 +1,32 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Detects which SIMD instruction sets the CPU supports,
+//                so that the fastest version of a kernel can be chosen
+//                at runtime.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+// SIMD instruction sets, from slowest to fastest
+enum SimdLevel {
+	SIMD_SCALAR = 0,
+	SIMD_SSE = 1,  // SSE2
+	SIMD_AVX2 = 2
+};
+
+namespace CpuFeatures {
+	// Returns the best instruction set supported by both the CPU and the OS.
+	// The CPU is only queried the first time this is called.
+	SimdLevel getSimdLevel();
+
+	// Returns a human readable name for the instruction set
+	const char* getSimdLevelName(SimdLevel level);
+}
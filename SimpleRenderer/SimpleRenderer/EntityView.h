@@ -0,0 +1,78 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A cached list of the entities that have at least
+//                a given set of components.
+//                The list is updated incrementally as component masks
+//                change, so systems don't need to filter every entity
+//                each frame.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include "SparseIndex.h"
+#include "Utils.h"
+
+#include <vector>
+
+// A non owning reference to a list of entity IDs
+using EntitySpan = Span<const size_t>;
+
+class EntityView {
+public:
+	explicit EntityView(size_t componentMask)
+		: m_componentMask{ componentMask }
+	{ }
+
+	// Returns the components an entity needs to be in the view
+	size_t getComponentMask() const { return m_componentMask; }
+
+	// Returns true if the entity is in the view
+	bool contains(size_t entityID) const { return m_index.has(entityID); }
+
+	// Adds or removes the entity from the view depending on its new component mask
+	void onComponentMaskChanged(size_t entityID, size_t componentMask)
+	{
+		if ((componentMask & m_componentMask) == m_componentMask)
+			add(entityID);
+		else
+			remove(entityID);
+	}
+
+	// Adds the entity to the view.
+	// Does nothing if the entity is already in the view.
+	void add(size_t entityID) { m_index.add(entityID); }
+
+	// Adds many entities to the view, growing each array once.
+	// Entities already in the view are skipped.
+	void add(const size_t* entityIDs, size_t count)
+	{
+		m_index.reserveFor(entityIDs, count);
+		for (size_t i = 0; i < count; ++i)
+			m_index.addReserved(entityIDs[i]);
+	}
+
+	// Removes the entity from the view in O(1) time.
+	// Does nothing if the entity is not in the view.
+	void remove(size_t entityID) { m_index.remove(entityID); }
+
+	// Returns the IDs of all entities in the view
+	const std::vector<size_t>& entities() const { return m_index.entities(); }
+
+	const size_t* data() const { return entities().data(); }
+	size_t size() const { return m_index.size(); }
+
+	std::vector<size_t>::const_iterator begin() const { return entities().begin(); }
+	std::vector<size_t>::const_iterator end() const { return entities().end(); }
+
+private:
+	size_t m_componentMask;
+	SparseIndex<> m_index;
+};
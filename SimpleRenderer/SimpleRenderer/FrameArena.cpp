@@ -0,0 +1,118 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A linear allocator for memory that only lives for a frame.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(size_t capacity)
+	: m_block{ allocateBlock(capacity) }
+	, m_offset{ 0 }
+	, m_overflowOffset{ 0 }
+	, m_size{ 0 }
+	, m_highWaterMark{ 0 }
+{
+}
+
+FrameArena::~FrameArena()
+{
+	reset();
+	freeBlock(m_block);
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+	size_t previousOffset = m_offset;
+	void* memory = allocateFromBlock(m_block, m_offset, size, alignment);
+	if (memory) {
+		m_size += m_offset - previousOffset;
+		return memory;
+	}
+
+	// Out of space, so carry on in an overflow block
+	if (!m_overflowBlocks.empty()) {
+		previousOffset = m_overflowOffset;
+		memory = allocateFromBlock(m_overflowBlocks.back(), m_overflowOffset, size, alignment);
+	}
+	if (!memory) {
+		m_overflowBlocks.push_back(allocateBlock(std::max(size + alignment, m_block.size)));
+		m_overflowOffset = 0;
+		previousOffset = 0;
+		memory = allocateFromBlock(m_overflowBlocks.back(), m_overflowOffset, size, alignment);
+	}
+	m_size += m_overflowOffset - previousOffset;
+	return memory;
+}
+
+void FrameArena::reset()
+{
+	m_highWaterMark = std::max(m_highWaterMark, m_size);
+
+	// Replace the overflow blocks with a single block big enough for everything,
+	// with some room to spare so that slightly bigger frames still fit
+	if (!m_overflowBlocks.empty()) {
+		for (const Block& block : m_overflowBlocks)
+			freeBlock(block);
+		m_overflowBlocks.clear();
+
+		freeBlock(m_block);
+		m_block = allocateBlock(m_highWaterMark + m_highWaterMark / 2);
+	}
+
+	m_offset = 0;
+	m_overflowOffset = 0;
+	m_size = 0;
+}
+
+size_t FrameArena::size() const
+{
+	return m_size;
+}
+
+size_t FrameArena::highWaterMark() const
+{
+	return std::max(m_highWaterMark, m_size);
+}
+
+size_t FrameArena::capacity() const
+{
+	return m_block.size;
+}
+
+FrameArena::Block FrameArena::allocateBlock(size_t size)
+{
+	if (size == 0)
+		return Block{ nullptr, 0 };
+	return Block{ static_cast<char*>(Memory::allocate(size, Memory::MEMORY_FRAME_ARENA)), size };
+}
+
+void FrameArena::freeBlock(const Block& block)
+{
+	Memory::deallocate(block.memory, block.size, Memory::MEMORY_FRAME_ARENA);
+}
+
+void* FrameArena::allocateFromBlock(const Block& block, size_t& offset, size_t size, size_t alignment)
+{
+	if (!block.memory)
+		return nullptr;
+
+	// Pad the offset so the address is aligned
+	uintptr_t address = reinterpret_cast<uintptr_t>(block.memory) + offset;
+	size_t padding = (alignment - address % alignment) % alignment;
+	if (offset + padding + size > block.size)
+		return nullptr;
+
+	offset += padding + size;
+	return block.memory + offset - size;
+}
@@ -0,0 +1,119 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A linear allocator for memory that only lives for a frame.
+//                Allocating just bumps a pointer, and everything is freed at
+//                once by reset. If a frame runs out of space the arena
+//                borrows overflow blocks, then grows to fit on the next reset,
+//                so frames of a steady size make no heap allocations.
+//                Blocks come from the memory pool, counted as MEMORY_FRAME_ARENA.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include "Memory.h"
+
+#include <cstddef>
+#include <vector>
+
+class FrameArena {
+public:
+	// Starts with a block of the specified number of bytes
+	explicit FrameArena(size_t capacity = 0);
+	~FrameArena();
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	// Returns size bytes aligned to alignment, which must be a power of two.
+	// The memory is valid until the next call to reset.
+	// Not thread safe.
+	void* allocate(size_t size, size_t alignment);
+
+	// Frees everything allocated since the last reset
+	void reset();
+
+	// Returns the bytes allocated since the last reset
+	size_t size() const;
+
+	// Returns the most bytes allocated between two resets
+	size_t highWaterMark() const;
+
+	// Returns the bytes that can be allocated without an overflow block
+	size_t capacity() const;
+
+private:
+	struct Block {
+		char* memory;
+		size_t size;
+	};
+
+	static Block allocateBlock(size_t size);
+	static void freeBlock(const Block& block);
+
+	// Returns memory from the end of the block, or nullptr if it doesn't fit
+	static void* allocateFromBlock(const Block& block, size_t& offset, size_t size, size_t alignment);
+
+	Block m_block;
+	size_t m_offset;
+
+	// Blocks used once m_block is full, freed on reset
+	std::vector<Block> m_overflowBlocks;
+	size_t m_overflowOffset;
+
+	// Bytes allocated since the last reset, including padding for alignment
+	size_t m_size;
+	size_t m_highWaterMark;
+};
+
+// A standard library allocator that allocates from a frame arena.
+// Deallocating does nothing, the memory is reclaimed when the arena is reset.
+template <typename T>
+class ArenaAllocator {
+public:
+	using value_type = T;
+
+	explicit ArenaAllocator(FrameArena& arena)
+		: m_arena{ &arena }
+	{ }
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other)
+		: m_arena{ other.getArena() }
+	{ }
+
+	T* allocate(size_t count)
+	{
+		return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T*, size_t)
+	{ }
+
+	FrameArena* getArena() const { return m_arena; }
+
+private:
+	FrameArena* m_arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+{
+	return lhs.getArena() == rhs.getArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+{
+	return lhs.getArena() != rhs.getArena();
+}
+
+// A vector that lives for a single frame
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
@@ -14,6 +14,7 @@
 #include "GLUtils.h"
 
 #include "InputSystem.h"
+#include "JobSystem.h"
 #include "MaterialComponent.h"
 #include "MeshComponent.h"
 #include "MovementComponent.h"
@@ -25,15 +26,209 @@
 #include <GLFW\glfw3.h>
 #include <glm\gtc\matrix_transform.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <map>
 #include <unordered_map>
 
-#define BUFFER_OFFSET(i) ((GLvoid *)(i*sizeof(float)))
-
 int g_kWindowWidth = 800;
 int g_kWindowHeight = 800;
 int g_kMovieBarHeight = 100;
 
+namespace {
+	// Textures and cube maps that have been loaded, keyed by filename(s)
+	std::unordered_map<std::string, GLuint> g_loadedTextures;
+	std::map<std::vector<std::string>, GLuint> g_loadedCubeMaps;
+
+	// The vertices and indices of every mesh, drawn through one VAO.
+	// Meshes are appended, and the buffers grow when they run out of room.
+	struct MeshArena {
+		GLuint VAO;
+		GLuint vertexBuffer;
+		GLuint indexBuffer;
+		size_t numVertices;
+		size_t vertexCapacity;
+		size_t numIndices;
+		size_t indexCapacity;
+	};
+
+	// The buffer bindings of the arena's VAO
+	const GLuint kVertexBufferBinding = 0;
+	const GLuint kInstanceBufferBinding = 1;
+
+	// Enough room for the built in meshes
+	const size_t kInitialArenaVertices = 1 << 14;
+	const size_t kInitialArenaIndices = 1 << 16;
+
+	// Creates a buffer with room for capacity bytes
+	GLuint createArenaBuffer(size_t capacity)
+	{
+		GLuint buffer;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STATIC_DRAW);
+		return buffer;
+	}
+
+	// Replaces the buffer with a bigger one, copying the bytes in use on the GPU
+	void growArenaBuffer(GLuint& buffer, size_t usedSize, size_t capacity)
+	{
+		GLuint newBuffer = createArenaBuffer(capacity);
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedSize);
+		glDeleteBuffers(1, &buffer);
+		buffer = newBuffer;
+	}
+
+	// Returns the mesh arena, creating it the first time
+	MeshArena& getMeshArena()
+	{
+		static MeshArena s_arena;
+		static bool s_arenaBuilt = false;
+
+		if (!s_arenaBuilt) {
+			s_arena = {};
+			s_arena.vertexCapacity = kInitialArenaVertices;
+			s_arena.indexCapacity = kInitialArenaIndices;
+			s_arena.vertexBuffer = createArenaBuffer(s_arena.vertexCapacity * sizeof(VertexFormat));
+			s_arena.indexBuffer = createArenaBuffer(s_arena.indexCapacity * sizeof(GLuint));
+
+			glGenVertexArrays(1, &s_arena.VAO);
+			glBindVertexArray(s_arena.VAO);
+
+			// Attributes are read through bindings, so the buffers can be replaced as they grow
+			GLuint positionLoc = 0;
+			GLuint normalLoc = 1;
+			GLuint texCoordLoc = 2;
+			GLuint entityIDLoc = 3;
+			glVertexAttribFormat(positionLoc, 3, GL_FLOAT, GL_FALSE, offsetof(VertexFormat, position));
+			glVertexAttribFormat(normalLoc, 3, GL_FLOAT, GL_FALSE, offsetof(VertexFormat, normal));
+			glVertexAttribFormat(texCoordLoc, 2, GL_FLOAT, GL_FALSE, offsetof(VertexFormat, texCoord));
+			glVertexAttribBinding(positionLoc, kVertexBufferBinding);
+			glVertexAttribBinding(normalLoc, kVertexBufferBinding);
+			glVertexAttribBinding(texCoordLoc, kVertexBufferBinding);
+
+			// One entity ID per instance, starting from the draw's base instance
+			glVertexAttribIFormat(entityIDLoc, 1, GL_UNSIGNED_INT, 0);
+			glVertexAttribBinding(entityIDLoc, kInstanceBufferBinding);
+			glVertexBindingDivisor(kInstanceBufferBinding, 1);
+
+			glEnableVertexAttribArray(positionLoc);
+			glEnableVertexAttribArray(normalLoc);
+			glEnableVertexAttribArray(texCoordLoc);
+			glEnableVertexAttribArray(entityIDLoc);
+
+			glBindVertexBuffer(kVertexBufferBinding, s_arena.vertexBuffer, 0, sizeof(VertexFormat));
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_arena.indexBuffer);
+			s_arenaBuilt = true;
+		}
+
+		return s_arena;
+	}
+
+	// An image loaded from a file, ready to be uploaded to the GPU
+	struct DecodedImage {
+		unsigned char* data;
+		int width;
+		int height;
+		int nrChannels;
+	};
+
+	// Loads an image file into memory.
+	// Safe to call from any thread.
+	DecodedImage decodeImage(const std::string& filename)
+	{
+		DecodedImage image;
+		image.data = stbi_load(filename.c_str(), &image.width, &image.height, &image.nrChannels, 0);
+		return image;
+	}
+
+	// Creates a mipmapped 2D texture from an image.
+	// Must be called from the thread that owns the GL context.
+	GLuint uploadTexture(const DecodedImage& image)
+	{
+		GLenum format;
+		switch (image.nrChannels)
+		{
+		case 1:
+			format = GL_R;
+			break;
+		case 2:
+			format = GL_RG;
+			break;
+		case 3:
+			format = GL_RGB;
+			break;
+		case 4:
+			format = GL_RGBA;
+			break;
+		default:
+			format = GL_RGBA;
+			break;
+		}
+
+		GLuint texture;
+		glGenTextures(1, &texture);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture);
+	
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		return texture;
+	}
+
+	// Creates a cube map from six images, in the order +X, -X, +Y, -Y, +Z, -Z.
+	// Must be called from the thread that owns the GL context.
+	GLuint uploadCubeMap(const DecodedImage* faces, size_t numFaces)
+	{
+		GLuint cubeMap;
+		glGenTextures(1, &cubeMap);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMap);
+
+		for (GLenum i = 0; i < numFaces; ++i) {
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 
+			             0, GL_RGB, faces[i].width, faces[i].height, 0, GL_RGB, GL_UNSIGNED_BYTE, faces[i].data);
+		}
+
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+		return cubeMap;
+	}
+
+	// Loads several image files into memory, in parallel if there is a job system
+	std::vector<DecodedImage> decodeImages(const std::vector<std::string>& filenames, JobSystem* jobSystem)
+	{
+		std::vector<DecodedImage> images(filenames.size());
+		auto decodeRange = [&filenames, &images](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+				images[i] = decodeImage(filenames[i]);
+		};
+
+		// Decoding doesn't touch OpenGL so it can be spread across threads
+		if (jobSystem)
+			jobSystem->parallelFor(filenames.size(), 1, decodeRange);
+		else
+			decodeRange(0, filenames.size());
+
+		return images;
+	}
+}
 
 // Callback for handling glfw errors
 void errorCallback(int error, const char* description)
@@ -48,7 +243,7 @@ void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 	glScissor(0, g_kMovieBarHeight, width, height - 2 * g_kMovieBarHeight);
 }
 
-GLFWwindow* GLUtils::initOpenGL()
+GLFWwindow* GLUtils::initOpenGL(bool isVisible)
 {
 	glfwSetErrorCallback(errorCallback);
 
@@ -61,6 +256,7 @@ GLFWwindow* GLUtils::initOpenGL()
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	glfwWindowHint(GLFW_STENCIL_BITS, 8);
 	glfwWindowHint(GLFW_SAMPLES, 4);
+	glfwWindowHint(GLFW_VISIBLE, isVisible ? GLFW_TRUE : GLFW_FALSE);
 	GLFWwindow* glContext = glfwCreateWindow(g_kWindowWidth, g_kWindowHeight, "Simple Renderer", nullptr, nullptr);
 	if (!glContext)
 	{
@@ -103,7 +299,7 @@ GLFWwindow* GLUtils::initOpenGL()
 
 GLuint GLUtils::getDefaultShader()
 {
-	static GLuint s_shader;
+	static ShaderProgram s_shader;
 	static bool s_shaderBuilt = false;
 
 	if (!s_shaderBuilt) {
@@ -114,12 +310,12 @@ GLuint GLUtils::getDefaultShader()
 		s_shaderBuilt = true;
 	}
 
-	return s_shader;
+	return s_shader.program;
 }
 
 GLuint GLUtils::getThresholdShader()
 {
-	static GLuint s_shader;
+	static ShaderProgram s_shader;
 	static bool s_shaderBuilt = false;
 
 	if (!s_shaderBuilt) {
@@ -130,12 +326,12 @@ GLuint GLUtils::getThresholdShader()
 		s_shaderBuilt = true;
 	}
 
-	return s_shader;
+	return s_shader.program;
 }
 
 GLuint GLUtils::getOutlineShader()
 {
-	static GLuint s_shader;
+	static ShaderProgram s_shader;
 	static bool s_shaderBuilt = false;
 
 	if (!s_shaderBuilt) {
@@ -146,12 +342,12 @@ GLuint GLUtils::getOutlineShader()
 		s_shaderBuilt = true;
 	}
 
-	return s_shader;
+	return s_shader.program;
 }
 
 GLuint GLUtils::getWaterShader()
 {
-	static GLuint s_shader;
+	static ShaderProgram s_shader;
 	static bool s_shaderBuilt = false;
 
 	if (!s_shaderBuilt) {
@@ -162,12 +358,12 @@ GLuint GLUtils::getWaterShader()
 		s_shaderBuilt = true;
 	}
 
-	return s_shader;
+	return s_shader.program;
 }
 
 GLuint GLUtils::getSkyboxShader()
 {
-	static GLuint s_shader;
+	static ShaderProgram s_shader;
 	static bool s_shaderBuilt = false;
 
 	if (!s_shaderBuilt) {
@@ -178,113 +374,178 @@ GLuint GLUtils::getSkyboxShader()
 		s_shaderBuilt = true;
 	}
 
-	return s_shader;
+	return s_shader.program;
+}
+
+namespace {
+	struct NamedShader {
+		const char* name;
+		GLuint(*get)();
+	};
+	const NamedShader g_kShaders[] = {
+		{ "default", &GLUtils::getDefaultShader },
+		{ "threshold", &GLUtils::getThresholdShader },
+		{ "outline", &GLUtils::getOutlineShader },
+		{ "water", &GLUtils::getWaterShader },
+		{ "skybox", &GLUtils::getSkyboxShader }
+	};
 }
 
-GLuint GLUtils::bufferVertices(const std::vector<VertexFormat>& vertices, const std::vector<GLuint>& indices)
+bool GLUtils::getShaderByName(const std::string& name, GLuint& outShader)
 {
-	GLuint VAO;
-	GLuint buffers[2];
-	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
-	glGenBuffers(1, &buffers[0]);
-	glGenBuffers(1, &buffers[1]);
-	glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexFormat) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices.size(), indices.data(), GL_STATIC_DRAW);
-	
-	GLuint positionLoc = 0;
-	GLuint normalLoc = 1;
-	GLuint texCoordLoc = 2;
-	glVertexAttribPointer(positionLoc, 3, GL_FLOAT, GL_FALSE, sizeof(VertexFormat), BUFFER_OFFSET(0));
-	glVertexAttribPointer(normalLoc, 3, GL_FLOAT, GL_FALSE, sizeof(VertexFormat), BUFFER_OFFSET(3));
-	glVertexAttribPointer(texCoordLoc, 2, GL_FLOAT, GL_FALSE, sizeof(VertexFormat), BUFFER_OFFSET(6));
-
-	glEnableVertexAttribArray(positionLoc);
-	glEnableVertexAttribArray(normalLoc);
-	glEnableVertexAttribArray(texCoordLoc);
-
-	return VAO;
+	for (const NamedShader& namedShader : g_kShaders) {
+		if (name == namedShader.name) {
+			outShader = namedShader.get();
+			return true;
+		}
+	}
+	return false;
 }
 
+bool GLUtils::getShaderName(GLuint shader, std::string& outName)
+{
+	for (const NamedShader& namedShader : g_kShaders) {
+		if (namedShader.get() == shader) {
+			outName = namedShader.name;
+			return true;
+		}
+	}
+	return false;
+}
 
-GLuint GLUtils::loadTexture(const std::string& filename)
+MeshComponent GLUtils::bufferVertices(const std::vector<VertexFormat>& vertices, const std::vector<GLuint>& indices)
 {
-	static std::unordered_map<std::string, GLuint> s_loadedTextures;
+	MeshArena& arena = getMeshArena();
 
-	// A texture with the same filepath has already been loaded, return a copy. (optimization)
-	if (s_loadedTextures.find(filename) != s_loadedTextures.end())
-		return s_loadedTextures.at(filename);
+	// Grow geometrically, so that adding meshes one at a time doesn't copy the arena every time
+	if (arena.numVertices + vertices.size() > arena.vertexCapacity) {
+		size_t capacity = std::max(arena.numVertices + vertices.size(), arena.vertexCapacity * 2);
+		growArenaBuffer(arena.vertexBuffer, arena.numVertices * sizeof(VertexFormat), capacity * sizeof(VertexFormat));
+		arena.vertexCapacity = capacity;
+	}
+	if (arena.numIndices + indices.size() > arena.indexCapacity) {
+		size_t capacity = std::max(arena.numIndices + indices.size(), arena.indexCapacity * 2);
+		growArenaBuffer(arena.indexBuffer, arena.numIndices * sizeof(GLuint), capacity * sizeof(GLuint));
+		arena.indexCapacity = capacity;
+	}
 
-	int width, height, nrChannels;
-	unsigned char* textureData = stbi_load(filename.c_str(), &width, &height, &nrChannels, 0);
+	// The VAO keeps reading from the arena's buffers, even if they were replaced
+	glBindVertexArray(arena.VAO);
+	glBindVertexBuffer(kVertexBufferBinding, arena.vertexBuffer, 0, sizeof(VertexFormat));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.indexBuffer);
 
-	GLenum format;
-	switch (nrChannels)
-	{
-	case 1:
-		format = GL_R;
-		break;
-	case 2:
-		format = GL_RG;
-		break;
-	case 3:
-		format = GL_RGB;
-		break;
-	case 4:
-		format = GL_RGBA;
-		break;
-	default:
-		format = GL_RGBA;
-		break;
-	}
+	// Indices are left as they are, the draw adds the base vertex to them
+	glBindBuffer(GL_ARRAY_BUFFER, arena.vertexBuffer);
+	glBufferSubData(GL_ARRAY_BUFFER, arena.numVertices * sizeof(VertexFormat), vertices.size() * sizeof(VertexFormat), vertices.data());
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, arena.numIndices * sizeof(GLuint), indices.size() * sizeof(GLuint), indices.data());
 
-	GLuint texture;
-	glGenTextures(1, &texture);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, texture);
-	
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	MeshComponent mesh;
+	mesh.VAO = arena.VAO;
+	mesh.numIndices = static_cast<GLsizei>(indices.size());
+	mesh.firstIndex = static_cast<GLuint>(arena.numIndices);
+	mesh.baseVertex = static_cast<GLint>(arena.numVertices);
+	mesh.vertices = &vertices;
+	mesh.indices = &indices;
+
+	arena.numVertices += vertices.size();
+	arena.numIndices += indices.size();
 
-	glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, textureData);
-	glGenerateMipmap(GL_TEXTURE_2D);
+	return mesh;
+}
 
-	stbi_image_free(textureData);
-	glBindTexture(GL_TEXTURE_2D, 0);
+void GLUtils::setInstanceBuffer(GLuint buffer)
+{
+	glBindVertexArray(getMeshArena().VAO);
+	glBindVertexBuffer(kInstanceBufferBinding, buffer, 0, sizeof(GLuint));
+}
 
-	s_loadedTextures.insert(std::make_pair(filename, texture));
+GLuint GLUtils::loadTexture(const std::string& filename)
+{
+	// A texture with the same filepath has already been loaded, return a copy. (optimization)
+	if (g_loadedTextures.find(filename) != g_loadedTextures.end())
+		return g_loadedTextures.at(filename);
+
+	DecodedImage image = decodeImage(filename);
+	GLuint texture = uploadTexture(image);
+	stbi_image_free(image.data);
+
+	g_loadedTextures.insert(std::make_pair(filename, texture));
 
 	return texture;
 }
 
-GLuint GLUtils::loadCubeMap(const std::vector<std::string>& faceFilenames)
+void GLUtils::loadTextures(const std::vector<std::string>& filenames, const std::vector<std::vector<std::string>>& cubeMapFaceFilenames, JobSystem& jobSystem)
 {
-	GLuint cubeMap;
-	glGenTextures(1, &cubeMap);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMap);
-
-	for (GLenum i = 0; i < faceFilenames.size(); ++i) {
-		int width, height, nrChannels;
-		unsigned char* faceData = stbi_load(faceFilenames.at(i).c_str(), &width, &height, 
-		                                    &nrChannels, 0);
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 
-		             0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, faceData);
-
-		stbi_image_free(faceData);
+	// Skip textures and cube maps that are already loaded, and duplicates
+	std::vector<std::string> toLoad;
+	for (const std::string& filename : filenames) {
+		if (g_loadedTextures.find(filename) == g_loadedTextures.end()
+		 && std::find(toLoad.begin(), toLoad.end(), filename) == toLoad.end())
+			toLoad.push_back(filename);
 	}
+	size_t numTextures = toLoad.size();
+
+	std::vector<const std::vector<std::string>*> cubeMapsToLoad;
+	for (const std::vector<std::string>& faceFilenames : cubeMapFaceFilenames) {
+		auto isSame = [&faceFilenames](const std::vector<std::string>* other) { return *other == faceFilenames; };
+		if (g_loadedCubeMaps.find(faceFilenames) == g_loadedCubeMaps.end()
+		 && std::find_if(cubeMapsToLoad.begin(), cubeMapsToLoad.end(), isSame) == cubeMapsToLoad.end()) {
+			cubeMapsToLoad.push_back(&faceFilenames);
+			toLoad.insert(toLoad.end(), faceFilenames.begin(), faceFilenames.end());
+		}
+	}
+
+	// Every face is decoded alongside the textures, as faces are the biggest images
+	std::vector<DecodedImage> images = decodeImages(toLoad, &jobSystem);
+
+	// Uploads must be made from the thread that owns the GL context
+	for (size_t i = 0; i < numTextures; ++i)
+		g_loadedTextures.insert(std::make_pair(toLoad[i], uploadTexture(images[i])));
+	size_t firstFace = numTextures;
+	for (const std::vector<std::string>* faceFilenames : cubeMapsToLoad) {
+		g_loadedCubeMaps.insert(std::make_pair(*faceFilenames, uploadCubeMap(&images[firstFace], faceFilenames->size())));
+		firstFace += faceFilenames->size();
+	}
+
+	for (DecodedImage& image : images)
+		stbi_image_free(image.data);
+}
+
+GLuint GLUtils::loadCubeMap(const std::vector<std::string>& faceFilenames)
+{
+	// A cube map with the same faces has already been loaded
+	auto it = g_loadedCubeMaps.find(faceFilenames);
+	if (it != g_loadedCubeMaps.end())
+		return it->second;
 
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	std::vector<DecodedImage> faces = decodeImages(faceFilenames, nullptr);
+	GLuint cubeMap = uploadCubeMap(faces.data(), faces.size());
+	for (DecodedImage& face : faces)
+		stbi_image_free(face.data);
 
-	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	g_loadedCubeMaps.insert(std::make_pair(faceFilenames, cubeMap));
 
 	return cubeMap;
 }
+
+bool GLUtils::getTextureFilename(GLuint texture, std::string& outFilename)
+{
+	for (const auto& loadedTexture : g_loadedTextures) {
+		if (loadedTexture.second == texture) {
+			outFilename = loadedTexture.first;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool GLUtils::getCubeMapFilenames(GLuint cubeMap, std::vector<std::string>& outFaceFilenames)
+{
+	for (const auto& loadedCubeMap : g_loadedCubeMaps) {
+		if (loadedCubeMap.second == cubeMap) {
+			outFaceFilenames = loadedCubeMap.first;
+			return true;
+		}
+	}
+	return false;
+}
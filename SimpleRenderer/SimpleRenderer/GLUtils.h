@@ -20,13 +20,16 @@
 #include <string>
 
 struct VertexFormat;
+struct MeshComponent;
 struct GLFWwindow;
 struct Scene;
 class InputSystem;
+class JobSystem;
 
 namespace GLUtils {
-	// Initializes the window, opengl context and opengl function pointers
-	GLFWwindow* initOpenGL();
+	// Initializes the window, opengl context and opengl function pointers.
+	// A hidden window still has a context, so assets can be loaded without drawing anything.
+	GLFWwindow* initOpenGL(bool isVisible = true);
 
 	// Returns a handler to the default shader.
 	// This function will build the shader if it is not already built.
@@ -48,15 +51,42 @@ namespace GLUtils {
 	// This function will build the sahder if it is not already built.
 	GLuint getSkyboxShader();
 
-	// Buffers vertex and index data to the GPU.
-	// Returns a handler the the VAO associated with the vertices / indices.
-	GLuint bufferVertices(const std::vector<VertexFormat>& vertices, const std::vector<GLuint>& indices);
+	// Gets a built in shader by name ("default", "threshold", "outline", "water" or "skybox").
+	// Returns false if there is no shader with the name.
+	bool getShaderByName(const std::string& name, GLuint& outShader);
+
+	// Gets the name of a built in shader.
+	// Returns false if the shader is not built in.
+	bool getShaderName(GLuint shader, std::string& outName);
+
+	// Buffers vertex and index data to the GPU, appending it to the buffers shared by every mesh.
+	// Returns a mesh referring to the vertices and indices, which must outlive it.
+	MeshComponent bufferVertices(const std::vector<VertexFormat>& vertices, const std::vector<GLuint>& indices);
+
+	// Sets the buffer the shared VAO reads an entity ID for each instance from.
+	// A draw's first instance reads the ID at its base instance.
+	void setInstanceBuffer(GLuint buffer);
 
 	// Loads a texture to GPU memory.
 	// Returns a handler to the GPU texture.
 	GLuint loadTexture(const std::string& filename);
 
+	// Loads several textures and cube maps to GPU memory, so that later calls to
+	// loadTexture and loadCubeMap for the same files return straight away.
+	// Image files are decoded in parallel on the job system, then uploaded
+	// from the calling thread, which must own the GL context.
+	void loadTextures(const std::vector<std::string>& filenames, const std::vector<std::vector<std::string>>& cubeMapFaceFilenames, JobSystem& jobSystem);
+
 	// Loads a cube map to GPU memory.
 	// Returns a handler to the GPU cube map.
+	// Cube maps with the same faces are only loaded once.
 	GLuint loadCubeMap(const std::vector<std::string>& faceFilenames);
+
+	// Gets the filename a texture was loaded from by loadTexture.
+	// Returns false if the texture was not loaded by loadTexture.
+	bool getTextureFilename(GLuint texture, std::string& outFilename);
+
+	// Gets the face filenames a cube map was loaded from by loadCubeMap.
+	// Returns false if the cube map was not loaded by loadCubeMap.
+	bool getCubeMapFilenames(GLuint cubeMap, std::vector<std::string>& outFaceFilenames);
 }
\ No newline at end of file
@@ -14,61 +14,70 @@
 
 #include "GameplayLogicSystem.h"
 
+#include "CommandBuffer.h"
 #include "InputSystem.h"
 #include "InputComponent.h"
+#include "JobSystem.h"
 #include "ShaderParams.h"
 #include "Scene.h"
+#include "SceneUtils.h"
 #include "Utils.h"
 #include "LogicComponent.h"
 
 #include <GLFW\glfw3.h>
 #include <glm\glm.hpp>
-#include <glm\gtc\matrix_transform.hpp>
 
-GameplayLogicSystem::GameplayLogicSystem(Scene& scene, InputSystem& inputSystem)
+GameplayLogicSystem::GameplayLogicSystem(Scene& scene, InputSystem& inputSystem, JobSystem& jobSystem, CommandBuffer& commandBuffer)
 	: m_scene{ scene }
-	, m_oldPossessedEntity{ 0 }
-	, m_possessedEntity{ 0 }
-	, m_oldPossessedEntityUpdated{ true }
-	, m_newPossessedEntityUpdated{ false }
+	, m_jobSystem{ jobSystem }
+	, m_commandBuffer{ commandBuffer }
+	, m_oldPossessedEntity{}
+	, m_possessedEntity{}
+	, m_requestedPossessedEntity{ 0 }
+	, m_possessionChanged{ true }
 	, m_dTheta{ 0.01f }
 {
 	inputSystem.registerKeyObserver(this);
 }
 
-void GameplayLogicSystem::update(size_t entityID)
+void GameplayLogicSystem::beginFrame()
 {
-	// Update the currently possessed entity
-	if (!m_oldPossessedEntityUpdated && entityID == m_oldPossessedEntity) {
-		// Update the old possessed entity so it doesn't respond to input
-		size_t& componentMask = m_scene.componentMasks.at(entityID);
-		componentMask &= ~(COMPONENT_INPUT | COMPONENT_MOVEMENT);
-		m_oldPossessedEntityUpdated = true;
+	if (!m_possessionChanged)
 		return;
-	}
-	if (!m_newPossessedEntityUpdated && entityID == m_possessedEntity) {
-		// Update the new possessed entity so it response to input
-		size_t& componentMask = m_scene.componentMasks.at(entityID);
-		componentMask |= (COMPONENT_INPUT | COMPONENT_MOVEMENT);
-		m_newPossessedEntityUpdated = true;
-		return;
-	}
 
-	const size_t kSpinnable = COMPONENT_TRANSFORM | COMPONENT_MESH | COMPONENT_LOGIC;
-	if ((m_scene.componentMasks.at(entityID) & kSpinnable) == kSpinnable) {
-		glm::mat4& transform = m_scene.transformComponents.at(entityID);
-		LogicComponent& logicVars = m_scene.logicComponents.at(entityID);
-		glm::vec3 pos = transform[3];
-		transform[3] = { 0, 0, 0, 1 }; // Remove displacement temporarily
-		transform = glm::rotate(transform, m_dTheta, logicVars.rotationAxis);
-		transform[3] = glm::vec4{ pos, 1 }; // Add displacement back in
+	// Update the old possessed entity so it doesn't respond to input.
+	// The command buffer skips the change if the entity has been destroyed.
+	m_commandBuffer.removeComponents(m_oldPossessedEntity, COMPONENT_INPUT | COMPONENT_MOVEMENT);
+
+	// Update the new possessed entity so it responds to input
+	if (SceneUtils::isAlive(m_scene, m_requestedPossessedEntity)) {
+		m_possessedEntity = SceneUtils::getHandle(m_scene, m_requestedPossessedEntity);
+		m_commandBuffer.addComponents(m_possessedEntity, COMPONENT_INPUT | COMPONENT_MOVEMENT);
 	}
 
+	m_possessionChanged = false;
+}
+
+void GameplayLogicSystem::update(EntitySpan)
+{
+	// Spin entities.
+	// Only the transforms of entities in kComponentMask have spin axes, and each
+	// transform is spun on its own, so ranges of the storage can be spun independently.
+	TransformStorage& transforms = m_scene.transformComponents;
+	float dTheta = m_dTheta;
+	m_jobSystem.parallelFor(transforms.size(), kGrainSize, [&transforms, dTheta](size_t begin, size_t end) {
+		transforms.spin(dTheta, begin, end - begin);
+	});
+
+	size_t possessedEntityID;
+	if (!SceneUtils::resolveHandle(m_scene, m_possessedEntity, possessedEntityID))
+		return;
+
 	const size_t kModifiableGlossMask = COMPONENT_MATERIAL | COMPONENT_INPUT;
-	if ((m_scene.componentMasks.at(entityID) & kModifiableGlossMask) == kModifiableGlossMask) {
+	if ((m_scene.componentMasks.at(possessedEntityID) & kModifiableGlossMask) == kModifiableGlossMask) {
 		// Alter the glossiness of the possessed entity on key event
-		InputComponent& input = m_scene.inputComponents.at(entityID);
-		ShaderParams& shaderParams = m_scene.materialComponents.at(entityID).shaderParams;
+		InputComponent& input = m_scene.inputComponents.at(possessedEntityID);
+		ShaderParams& shaderParams = m_scene.materialComponents.at(possessedEntityID).shaderParams;
 		if (input.btn1Down) {
 			shaderParams.glossiness = clamp(shaderParams.glossiness + 0.1f, 0.001f, 100.0f);
 		}
@@ -81,6 +90,8 @@ void GameplayLogicSystem::update(size_t entityID)
 		if (input.btn4Down) {
 			shaderParams.metallicness = clamp(shaderParams.metallicness - 0.01f, 0.0f, 1.0f);
 		}
+		if (input.btn1Down || input.btn2Down || input.btn3Down || input.btn4Down)
+			SceneUtils::markChanged(m_scene, possessedEntityID, COMPONENT_MATERIAL);
 	}
 }
 
@@ -98,16 +109,15 @@ void GameplayLogicSystem::keyCallback(int key, int scancode, int action, int mod
 	m_oldPossessedEntity = m_possessedEntity;
 
 	if (key == GLFW_KEY_1 && action == GLFW_PRESS)
-		m_possessedEntity = 0;
+		m_requestedPossessedEntity = 0;
 	else if (key == GLFW_KEY_2 && action == GLFW_PRESS)
-		m_possessedEntity = 1;
+		m_requestedPossessedEntity = 1;
 	else if (key == GLFW_KEY_3 && action == GLFW_PRESS)
-		m_possessedEntity = 2;
+		m_requestedPossessedEntity = 2;
 	else if (key == GLFW_KEY_4 && action == GLFW_PRESS)
-		m_possessedEntity = 3;
+		m_requestedPossessedEntity = 3;
 	/*else if (key == GLFW_KEY_5 && action == GLFW_PRESS)
-		m_possessedEntity = 4;*/
+		m_requestedPossessedEntity = 4;*/
 
-	m_oldPossessedEntityUpdated = false;
-	m_newPossessedEntityUpdated = false;
+	m_possessionChanged = true;
 }
@@ -15,27 +15,52 @@
 #pragma once
 
 #include "KeyObserver.h"
+#include "Scene.h"
 
-struct Scene;
+class CommandBuffer;
 class InputSystem;
+class JobSystem;
 
 class GameplayLogicSystem : IKeyObserver {
 public:
-	GameplayLogicSystem(Scene& scene, InputSystem& inputSystem);
+	GameplayLogicSystem(Scene& scene, InputSystem& inputSystem, JobSystem& jobSystem, CommandBuffer& commandBuffer);
 
-	// Runs the logic system on the specified entity
-	void update(size_t entityID);
+	// The components an entity needs to be spun by the logic system
+	static const size_t kComponentMask = kSpinComponents;
+
+	// The number of transforms spun by each job
+	static const size_t kGrainSize = 4096;
+
+	// The components used by update, for scheduling
+	static const size_t kReadMask = COMPONENT_TRANSFORM | COMPONENT_LOGIC | COMPONENT_MATERIAL | COMPONENT_INPUT;
+	static const size_t kWriteMask = COMPONENT_TRANSFORM | COMPONENT_MATERIAL;
+	static const bool kMainThreadOnly = false;
+
+	// Records any change of possessed entity requested since the last frame.
+	// Must be called before the command buffer is flushed and the other systems
+	// are updated, so that the newly possessed entity responds to input in the same frame.
+	void beginFrame();
+
+	// Runs the logic system.
+	// The entities with the components in kComponentMask are spun in parallel on
+	// the job system, straight from the transform storage's rotation arrays.
+	// The possessed entity's material is also updated from its input.
+	void update(EntitySpan);
 
 	// Callback for observing key press events
 	virtual void keyCallback(int key, int scancode, int action, int mods) override;
 
 private:
 	Scene& m_scene;
-	size_t m_oldPossessedEntity;
-	size_t m_possessedEntity;
-	bool m_oldPossessedEntityUpdated;
-	bool m_newPossessedEntityUpdated;
+	JobSystem& m_jobSystem;
+	CommandBuffer& m_commandBuffer;
+	EntityHandle m_oldPossessedEntity;
+	EntityHandle m_possessedEntity;
+
+	// The entity ID selected for possession by keyboard input
+	size_t m_requestedPossessedEntity;
+	bool m_possessionChanged;
 
-	// Change in object rotation per frame
+	// Change in object rotation per simulation step
 	float m_dTheta;
 };
\ No newline at end of file
@@ -7,7 +7,8 @@
 // (c) 2017 Media Design School
 //
 // Description  : A component for receving input.
-//                Input mappings are also set in this component.
+//                Input mappings are kept in binding profiles shared by many
+//                components, so the component only holds per frame state.
 // Author       : Lance Chaney
 // Mail         : lance.cha7337@mediadesign.school.nz
 //
@@ -17,14 +18,11 @@
 #include <GLFW\glfw3.h>
 #include <glm\glm.hpp>
 
-struct InputComponent {
-	glm::vec3 axis;
-	glm::vec3 orientationDelta;
-	bool btn1Down;
-	bool btn2Down;
-	bool btn3Down;
-	bool btn4Down;
+#include <cstdint>
 
+// Keys that drive an input component.
+// Unbound keys are 0.
+struct InputBindings {
 	int leftBtnMap;
 	int rightBtnMap;
 	int forwardBtnMap;
@@ -41,4 +39,14 @@ struct InputComponent {
 	int btn2Map;
 	int btn3Map;
 	int btn4Map;
-};
\ No newline at end of file
+};
+
+struct InputComponent {
+	glm::vec3 axis;
+	glm::vec3 orientationDelta;
+	uint32_t bindings; // Index into Scene::inputBindings
+	bool btn1Down;
+	bool btn2Down;
+	bool btn3Down;
+	bool btn4Down;
+};
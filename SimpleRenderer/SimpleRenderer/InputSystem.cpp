@@ -26,6 +26,8 @@ InputSystem::InputSystem(GLFWwindow* window, RenderSystem& renderSystem, Scene&
 	: m_window{ window }
 	, m_renderSystem{ renderSystem }
 	, m_scene{ scene }
+	, m_mouseDelta{}
+	, m_keysDown{}
 {
 	// Register input system as a listener for keyboard events
 	glfwSetWindowUserPointer(window, this);
@@ -66,6 +68,7 @@ void InputSystem::mouseBtnCallback(int button, int action, int mods)
 		size_t outEntityID;
 		if (m_renderSystem.mousePick(mousePos, outEntityID)) {
 			m_scene.materialComponents[outEntityID].hasOutline = !m_scene.materialComponents[outEntityID].hasOutline;
+			SceneUtils::markChanged(m_scene, outEntityID, COMPONENT_MATERIAL);
 		}
 	}
 }
@@ -85,56 +88,73 @@ void InputSystem::beginFrame()
 	glm::dvec2 mousePos;
 	glfwGetCursorPos(m_window, &mousePos.x, &mousePos.y);
 
-	// Update mouse delta
-	m_mouseDelta = mousePos - lastMousePos;
+	// Update mouse delta.
+	// Movement is kept until a step uses it, as a frame may not simulate any steps.
+	m_mouseDelta += mousePos - lastMousePos;
 
 	lastMousePos = mousePos;
+
+	// Capture the keyboard, starting from the first valid key
+	for (int key = GLFW_KEY_SPACE; key <= GLFW_KEY_LAST; ++key)
+		m_keysDown[key] = glfwGetKey(m_window, key) == GLFW_PRESS;
 }
 
-void InputSystem::update(size_t entityID)
+void InputSystem::endStep()
 {
-	// Filter input receivers
-	const size_t kInputReceiverMask = COMPONENT_INPUT;
-	if ((m_scene.componentMasks.at(entityID) & kInputReceiverMask) != kInputReceiverMask)
-		return;
+	m_mouseDelta = {};
+}
+
+bool InputSystem::isKeyDown(int key) const
+{
+	return key > 0 && key <= GLFW_KEY_LAST && m_keysDown[key];
+}
 
+void InputSystem::update(EntitySpan entities)
+{
+	for (size_t entityID : entities)
+		updateEntity(entityID);
+}
+
+void InputSystem::updateEntity(size_t entityID)
+{
 	InputComponent& input = m_scene.inputComponents.at(entityID);
+	const InputBindings& bindings = m_scene.inputBindings.at(input.bindings);
 
 	// Update input from mouse
 	input.orientationDelta = {};
-	if (input.mouseInputEnabled)
+	if (bindings.mouseInputEnabled)
 		input.orientationDelta = glm::vec3{ m_mouseDelta, 0 };
 
 	// Update input from buttons
 	input.axis = {};
-	if (input.leftBtnMap && glfwGetKey(m_window, input.leftBtnMap) == GLFW_PRESS)
+	if (isKeyDown(bindings.leftBtnMap))
 		input.axis.x -= 1;
-	if (input.rightBtnMap && glfwGetKey(m_window, input.rightBtnMap) == GLFW_PRESS)
+	if (isKeyDown(bindings.rightBtnMap))
 		input.axis.x += 1;
-	if (input.forwardBtnMap && glfwGetKey(m_window, input.forwardBtnMap) == GLFW_PRESS)
+	if (isKeyDown(bindings.forwardBtnMap))
 		input.axis.z -= 1;
-	if (input.backwardBtnMap && glfwGetKey(m_window, input.backwardBtnMap) == GLFW_PRESS)
+	if (isKeyDown(bindings.backwardBtnMap))
 		input.axis.z += 1;
-	if (input.downBtnMap && glfwGetKey(m_window, input.downBtnMap) == GLFW_PRESS)
+	if (isKeyDown(bindings.downBtnMap))
 		input.axis.y -= 1;
-	if (input.upBtnMap && glfwGetKey(m_window, input.upBtnMap) == GLFW_PRESS)
+	if (isKeyDown(bindings.upBtnMap))
 		input.axis.y += 1;
-	if (input.azimuthPosBtnMap && glfwGetKey(m_window, input.azimuthPosBtnMap) == GLFW_PRESS)
+	if (isKeyDown(bindings.azimuthPosBtnMap))
 		input.orientationDelta.x += 1;
-	if (input.azimuthNegBtnMap && glfwGetKey(m_window, input.azimuthNegBtnMap) == GLFW_PRESS)
+	if (isKeyDown(bindings.azimuthNegBtnMap))
 		input.orientationDelta.x -= 1;
-	if (input.elevationPosBtnMap && glfwGetKey(m_window, input.elevationPosBtnMap) == GLFW_PRESS)
+	if (isKeyDown(bindings.elevationPosBtnMap))
 		input.orientationDelta.y += 1;
-	if (input.elevationNegBtnMap && glfwGetKey(m_window, input.elevationNegBtnMap) == GLFW_PRESS)
+	if (isKeyDown(bindings.elevationNegBtnMap))
 		input.orientationDelta.y -= 1;
-	if (input.rollBtnMap && glfwGetKey(m_window, input.rollBtnMap) == GLFW_PRESS)
+	if (isKeyDown(bindings.rollBtnMap))
 		input.orientationDelta.z += 1;
-	if (input.btn1Map)
-		input.btn1Down = glfwGetKey(m_window, input.btn1Map) == GLFW_PRESS;
-	if (input.btn2Map)
-		input.btn2Down = glfwGetKey(m_window, input.btn2Map) == GLFW_PRESS;
-	if (input.btn3Map)
-		input.btn3Down = glfwGetKey(m_window, input.btn3Map) == GLFW_PRESS;
-	if (input.btn4Map)
-		input.btn4Down = glfwGetKey(m_window, input.btn4Map) == GLFW_PRESS;
+	if (bindings.btn1Map)
+		input.btn1Down = isKeyDown(bindings.btn1Map);
+	if (bindings.btn2Map)
+		input.btn2Down = isKeyDown(bindings.btn2Map);
+	if (bindings.btn3Map)
+		input.btn3Down = isKeyDown(bindings.btn3Map);
+	if (bindings.btn4Map)
+		input.btn4Down = isKeyDown(bindings.btn4Map);
 }
\ No newline at end of file
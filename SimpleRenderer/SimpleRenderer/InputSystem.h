@@ -13,12 +13,15 @@
 
 #pragma once
 
+#include "Scene.h"
+
 #include <glm\glm.hpp>
+#include <GLFW\glfw3.h>
 
+#include <array>
 #include <functional>
 #include <vector>
 
-struct Scene;
 struct GLFWwindow;
 class IKeyObserver;
 class RenderSystem;
@@ -27,12 +30,28 @@ class InputSystem {
 public:
 	InputSystem(GLFWwindow* window, RenderSystem&, Scene&);
 
-	// Updates the entity with input
-	void update(size_t entityID);
+	// The components an entity needs to receive input
+	static const size_t kComponentMask = COMPONENT_INPUT;
+
+	// The components used by update, for scheduling.
+	// update reads the keys captured by beginFrame, so it can run on any thread.
+	static const size_t kReadMask = COMPONENT_NONE;
+	static const size_t kWriteMask = COMPONENT_INPUT;
+	static const bool kMainThreadOnly = false;
+
+	// Updates the entities with input.
+	// The entities must have the components in kComponentMask.
+	void update(EntitySpan entities);
 
-	// Does per frame input system update
+	// Does per frame input system update.
+	// Captures the mouse and keyboard state for update to use, as
+	// GLFW can only be queried from the main thread.
 	void beginFrame();
 
+	// Call after each simulation step.
+	// Mouse movement is only applied by the first step after it happened.
+	void endStep();
+
 	// Registers observers for keyboard input
 	void registerKeyObserver(IKeyObserver* observer);
 
@@ -42,9 +61,17 @@ private:
 
 	void mouseBtnCallback(int button, int action, int mods);
 
+	// Updates a single entity with input
+	void updateEntity(size_t entityID);
+
+	// Returns true if the key was down when beginFrame was called.
+	// Key 0 is used for unbound buttons and is never down.
+	bool isKeyDown(int key) const;
+
 	GLFWwindow* m_window;
 	Scene& m_scene;
 	RenderSystem& m_renderSystem;
 	glm::dvec2 m_mouseDelta;
+	std::array<bool, GLFW_KEY_LAST + 1> m_keysDown;
 	std::vector<IKeyObserver*> m_keyObservers;
 };
\ No newline at end of file
@@ -0,0 +1,196 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A work stealing thread pool for running jobs across
+//                all cores.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <utility>
+
+// The job system and worker index of the calling thread.
+// Only set on worker threads.
+thread_local const JobSystem* t_jobSystem = nullptr;
+thread_local size_t t_workerIndex = 0;
+
+JobSystem::JobSystem(size_t numWorkers)
+	: m_queuedJobs{ 0 }
+	, m_stopping{ false }
+{
+	// One queue per worker plus a shared queue for jobs submitted from other threads
+	for (size_t i = 0; i < numWorkers + 1; ++i)
+		m_queues.emplace_back(new WorkQueue);
+
+	for (size_t i = 0; i < numWorkers; ++i)
+		m_workers.emplace_back(&JobSystem::workerMain, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_stopping = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (auto& worker : m_workers)
+		worker.join();
+}
+
+void JobSystem::submit(JobGroup& group, Job job)
+{
+	++group.m_pendingJobs;
+
+	WorkQueue& queue = getOwnQueue();
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(QueuedJob{ std::move(job), &group });
+	}
+	++m_queuedJobs;
+
+	// Wake up a sleeping worker.
+	// The mutex is locked so the notification can't be missed by a worker
+	// that is about to go to sleep.
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+	}
+	m_wakeCondition.notify_one();
+}
+
+void JobSystem::wait(JobGroup& group)
+{
+	while (!group.isDone()) {
+		if (!tryRunJob())
+			std::this_thread::yield();
+	}
+
+	std::exception_ptr exception;
+	{
+		std::lock_guard<std::mutex> lock(group.m_exceptionMutex);
+		std::swap(exception, group.m_exception);
+	}
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
+void JobSystem::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func)
+{
+	if (count == 0)
+		return;
+
+	// Not worth splitting up small amounts of work
+	grainSize = std::max<size_t>(grainSize, 1);
+	if (count <= grainSize || m_workers.empty()) {
+		func(0, count);
+		return;
+	}
+
+	JobGroup group;
+	for (size_t begin = 0; begin < count; begin += grainSize) {
+		size_t end = std::min(begin + grainSize, count);
+		submit(group, [&func, begin, end]() {
+			func(begin, end);
+		});
+	}
+	wait(group);
+}
+
+size_t JobSystem::getWorkerCount() const
+{
+	return m_workers.size();
+}
+
+size_t JobSystem::defaultWorkerCount()
+{
+	size_t numCores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	return numCores - 1;
+}
+
+void JobSystem::workerMain(size_t workerIndex)
+{
+	t_jobSystem = this;
+	t_workerIndex = workerIndex;
+
+	while (true) {
+		if (tryRunJob())
+			continue;
+
+		// Sleep until there is more work to do
+		std::unique_lock<std::mutex> lock(m_wakeMutex);
+		m_wakeCondition.wait(lock, [this]() {
+			return m_stopping || m_queuedJobs > 0;
+		});
+
+		if (m_stopping && m_queuedJobs == 0)
+			return;
+	}
+}
+
+bool JobSystem::tryRunJob()
+{
+	QueuedJob queuedJob;
+	if (!popOwnJob(queuedJob) && !stealJob(queuedJob))
+		return false;
+
+	// The job still counts as finished if it throws, otherwise its group would never
+	// be done. The exception is handed to the thread waiting on the group.
+	JobGroup& group = *queuedJob.group;
+	try {
+		queuedJob.job();
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> lock(group.m_exceptionMutex);
+		if (!group.m_exception)
+			group.m_exception = std::current_exception();
+	}
+	--group.m_pendingJobs;
+	return true;
+}
+
+bool JobSystem::popOwnJob(QueuedJob& outJob)
+{
+	WorkQueue& queue = getOwnQueue();
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.jobs.empty())
+		return false;
+
+	outJob = std::move(queue.jobs.back());
+	queue.jobs.pop_back();
+	--m_queuedJobs;
+	return true;
+}
+
+bool JobSystem::stealJob(QueuedJob& outJob)
+{
+	// Start with the queue after our own so that thieves spread out across victims
+	size_t start = (t_jobSystem == this) ? t_workerIndex + 1 : 0;
+	for (size_t i = 0; i < m_queues.size(); ++i) {
+		WorkQueue& queue = *m_queues[(start + i) % m_queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty())
+			continue;
+
+		outJob = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+		--m_queuedJobs;
+		return true;
+	}
+
+	return false;
+}
+
+JobSystem::WorkQueue& JobSystem::getOwnQueue()
+{
+	if (t_jobSystem == this)
+		return *m_queues[t_workerIndex];
+	return *m_queues.back();
+}
@@ -0,0 +1,123 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A work stealing thread pool for running jobs across
+//                all cores.
+//                Each worker owns a deque of jobs. Workers push and pop
+//                jobs at the back of their own deque and steal from the
+//                front of other workers' deques when they run out of work.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Tracks a group of jobs so they can be waited on together
+class JobGroup {
+public:
+	JobGroup()
+		: m_pendingJobs{ 0 }
+	{ }
+	JobGroup(const JobGroup&) = delete;
+	JobGroup& operator=(const JobGroup&) = delete;
+
+	// Returns true when all jobs in the group have finished
+	bool isDone() const { return m_pendingJobs.load() == 0; }
+
+private:
+	friend class JobSystem;
+
+	std::atomic<size_t> m_pendingJobs;
+
+	// The first exception thrown by a job in the group, rethrown by JobSystem::wait
+	std::mutex m_exceptionMutex;
+	std::exception_ptr m_exception;
+};
+
+class JobSystem {
+public:
+	using Job = std::function<void()>;
+
+	// Starts the specified number of worker threads.
+	// By default one worker is started for each core other than the main thread's,
+	// the main thread also runs jobs while it waits.
+	explicit JobSystem(size_t numWorkers = defaultWorkerCount());
+	~JobSystem();
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Queues a job to be run on any thread.
+	// The group must outlive the job.
+	void submit(JobGroup& group, Job job);
+
+	// Blocks until all jobs in the group have finished.
+	// The calling thread runs queued jobs while it waits.
+	// If any job in the group threw, the first exception is rethrown once
+	// every job has finished.
+	void wait(JobGroup& group);
+
+	// Calls func(begin, end) for consecutive ranges of at most grainSize
+	// indices covering [0, count), spread across all threads.
+	// Returns once every range has been processed.
+	// If func throws, the first exception is rethrown once every range has finished.
+	void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func);
+
+	// Returns the number of worker threads
+	size_t getWorkerCount() const;
+
+	// Returns the default number of worker threads for this machine
+	static size_t defaultWorkerCount();
+
+private:
+	struct QueuedJob {
+		Job job;
+		JobGroup* group;
+	};
+
+	// A deque of jobs owned by a worker (or the shared queue for non worker threads)
+	struct WorkQueue {
+		std::mutex mutex;
+		std::deque<QueuedJob> jobs;
+	};
+
+	// The main loop of each worker thread
+	void workerMain(size_t workerIndex);
+
+	// Runs a single queued job if one can be found.
+	// Returns false if there was no work to do.
+	bool tryRunJob();
+
+	// Pops a job from the back of the calling thread's own queue
+	bool popOwnJob(QueuedJob& outJob);
+
+	// Steals a job from the front of another queue
+	bool stealJob(QueuedJob& outJob);
+
+	// Returns the queue owned by the calling thread
+	WorkQueue& getOwnQueue();
+
+	std::vector<std::thread> m_workers;
+
+	// One queue per worker, the final queue is shared by non worker threads
+	std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+	std::atomic<size_t> m_queuedJobs;
+	std::atomic<bool> m_stopping;
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wakeCondition;
+};
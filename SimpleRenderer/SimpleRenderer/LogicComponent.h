@@ -17,6 +17,7 @@
 #include <glm\glm.hpp>
 
 struct LogicComponent {
-	// The axis about which the object should rotate
+	// The axis about which the object should rotate.
+	// Change with SceneUtils::setRotationAxis so the transform's spin axis follows.
 	glm::vec3 rotationAxis;
 };
\ No newline at end of file
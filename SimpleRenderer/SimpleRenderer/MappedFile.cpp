@@ -0,0 +1,109 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A read only view of a file mapped into memory.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filename)
+	: m_data{ nullptr }
+	, m_size{ 0 }
+	, m_file{ INVALID_HANDLE_VALUE }
+	, m_mapping{ nullptr }
+{
+	m_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("MappedFile: could not open " + filename);
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size)) {
+		CloseHandle(m_file);
+		throw std::runtime_error("MappedFile: could not get the size of " + filename);
+	}
+	m_size = static_cast<size_t>(size.QuadPart);
+
+	// Empty files can't be mapped
+	if (m_size == 0)
+		return;
+
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping)
+		m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!m_data) {
+		if (m_mapping)
+			CloseHandle(m_mapping);
+		CloseHandle(m_file);
+		throw std::runtime_error("MappedFile: could not map " + filename);
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename)
+	: m_data{ nullptr }
+	, m_size{ 0 }
+	, m_file{ -1 }
+{
+	m_file = open(filename.c_str(), O_RDONLY);
+	if (m_file == -1)
+		throw std::runtime_error("MappedFile: could not open " + filename);
+
+	struct stat fileStats;
+	if (fstat(m_file, &fileStats) != 0) {
+		close(m_file);
+		throw std::runtime_error("MappedFile: could not get the size of " + filename);
+	}
+	m_size = static_cast<size_t>(fileStats.st_size);
+
+	// Empty files can't be mapped
+	if (m_size == 0)
+		return;
+
+	void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+	if (data == MAP_FAILED) {
+		close(m_file);
+		throw std::runtime_error("MappedFile: could not map " + filename);
+	}
+	m_data = static_cast<const unsigned char*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_data)
+		munmap(const_cast<unsigned char*>(m_data), m_size);
+	close(m_file);
+}
+
+#endif
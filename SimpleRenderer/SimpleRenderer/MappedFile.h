@@ -0,0 +1,43 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A read only view of a file mapped into memory.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include <string>
+
+class MappedFile {
+public:
+	// Maps the whole file into memory.
+	// Throws std::runtime_error if the file can't be opened or mapped.
+	explicit MappedFile(const std::string& filename);
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Returns the start of the file's contents
+	const unsigned char* data() const { return m_data; }
+
+	// Returns the size of the file in bytes
+	size_t size() const { return m_size; }
+
+private:
+	const unsigned char* m_data;
+	size_t m_size;
+
+#ifdef _WIN32
+	void* m_file;
+	void* m_mapping;
+#else
+	int m_file;
+#endif
+};
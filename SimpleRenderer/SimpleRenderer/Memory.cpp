@@ -0,0 +1,156 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A shared pool of memory blocks, with statistics kept for
+//                each subsystem that allocates from it.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "Memory.h"
+
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+	// Blocks are powers of two from 64 bytes to kMaxBlockSize.
+	// Larger allocations go straight to the heap, as rounding them up would waste too much.
+	const size_t kMinBlockSizeLog2 = 6;
+	const size_t kMaxBlockSizeLog2 = 20;
+	const size_t kMaxBlockSize = static_cast<size_t>(1) << kMaxBlockSizeLog2;
+
+	std::mutex g_mutex;
+	std::array<std::vector<void*>, kMaxBlockSizeLog2 + 1> g_freeBlocks; // Indexed by log2 of the block size
+	std::array<Memory::Stats, Memory::kNumSubsystems> g_stats{};
+
+	// Returns log2 of the smallest block that can hold size bytes
+	size_t getSizeClass(size_t size)
+	{
+		size_t sizeClass = kMinBlockSizeLog2;
+		while ((static_cast<size_t>(1) << sizeClass) < size)
+			++sizeClass;
+		return sizeClass;
+	}
+
+	Memory::Stats& getStatsForUpdate(Memory::Subsystem subsystem)
+	{
+		if (subsystem >= Memory::kNumSubsystems)
+			throw std::out_of_range("Memory: invalid subsystem");
+		return g_stats[subsystem];
+	}
+
+	// Must be called with g_mutex locked
+	void recordAllocationLocked(Memory::Subsystem subsystem, size_t size, bool isHeapAllocation)
+	{
+		Memory::Stats& stats = getStatsForUpdate(subsystem);
+		stats.bytesInUse += size;
+		stats.highWaterMark = std::max(stats.highWaterMark, stats.bytesInUse);
+		++stats.numAllocations;
+		if (isHeapAllocation)
+			++stats.numHeapAllocations;
+	}
+}
+
+void* Memory::allocate(size_t size, Subsystem subsystem)
+{
+	if (size > kMaxBlockSize) {
+		void* memory = ::operator new(size);
+		std::lock_guard<std::mutex> lock(g_mutex);
+		recordAllocationLocked(subsystem, size, true);
+		return memory;
+	}
+
+	size_t sizeClass = getSizeClass(size);
+	{
+		std::lock_guard<std::mutex> lock(g_mutex);
+		std::vector<void*>& freeBlocks = g_freeBlocks[sizeClass];
+		if (!freeBlocks.empty()) {
+			void* memory = freeBlocks.back();
+			freeBlocks.pop_back();
+			recordAllocationLocked(subsystem, size, false);
+			return memory;
+		}
+	}
+
+	// No free block of the right size, so make a new one
+	void* memory = ::operator new(static_cast<size_t>(1) << sizeClass);
+	std::lock_guard<std::mutex> lock(g_mutex);
+	recordAllocationLocked(subsystem, size, true);
+	return memory;
+}
+
+void Memory::deallocate(void* memory, size_t size, Subsystem subsystem)
+{
+	if (!memory)
+		return;
+
+	std::lock_guard<std::mutex> lock(g_mutex);
+	getStatsForUpdate(subsystem).bytesInUse -= size;
+	if (size > kMaxBlockSize)
+		::operator delete(memory);
+	else
+		g_freeBlocks[getSizeClass(size)].push_back(memory);
+}
+
+void Memory::recordAllocation(Subsystem subsystem, size_t size, bool isHeapAllocation)
+{
+	std::lock_guard<std::mutex> lock(g_mutex);
+	recordAllocationLocked(subsystem, size, isHeapAllocation);
+}
+
+void Memory::recordDeallocation(Subsystem subsystem, size_t size)
+{
+	std::lock_guard<std::mutex> lock(g_mutex);
+	getStatsForUpdate(subsystem).bytesInUse -= size;
+}
+
+Memory::Stats Memory::getStats(Subsystem subsystem)
+{
+	std::lock_guard<std::mutex> lock(g_mutex);
+	return getStatsForUpdate(subsystem);
+}
+
+const char* Memory::getSubsystemName(Subsystem subsystem)
+{
+	switch (subsystem) {
+	case MEMORY_COMPONENTS:
+		return "Components";
+	case MEMORY_TRANSFORMS:
+		return "Transforms";
+	case MEMORY_RENDER_STATE:
+		return "RenderState";
+	case MEMORY_FRAME_ARENA:
+		return "FrameArena";
+	default:
+		return "Unknown";
+	}
+}
+
+void Memory::printStats(std::ostream& out)
+{
+	out << std::left << std::setw(12) << "Subsystem"
+		<< std::right << std::setw(14) << "Bytes in use"
+		<< std::setw(14) << "High water"
+		<< std::setw(14) << "Allocations"
+		<< std::setw(14) << "From heap" << std::endl;
+	for (size_t i = 0; i < kNumSubsystems; ++i) {
+		Subsystem subsystem = static_cast<Subsystem>(i);
+		Stats stats = getStats(subsystem);
+		out << std::left << std::setw(12) << getSubsystemName(subsystem)
+			<< std::right << std::setw(14) << stats.bytesInUse
+			<< std::setw(14) << stats.highWaterMark
+			<< std::setw(14) << stats.numAllocations
+			<< std::setw(14) << stats.numHeapAllocations << std::endl;
+	}
+}
@@ -0,0 +1,65 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A shared pool of memory blocks, with statistics kept for
+//                each subsystem that allocates from it.
+//                Freed blocks are kept for reuse instead of being returned
+//                to the heap, so once a subsystem's containers stop growing
+//                it makes no more heap allocations.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+
+namespace Memory {
+	// The parts of the program that memory is tracked for
+	enum Subsystem {
+		MEMORY_COMPONENTS,
+		MEMORY_TRANSFORMS,
+		MEMORY_RENDER_STATE,
+		MEMORY_FRAME_ARENA
+	};
+
+	// The number of values in Subsystem
+	const size_t kNumSubsystems = 4;
+
+	struct Stats {
+		size_t bytesInUse;         // Bytes currently allocated by the subsystem
+		size_t highWaterMark;      // The most bytes the subsystem has had allocated at once
+		size_t numAllocations;     // Allocations made by the subsystem
+		size_t numHeapAllocations; // Allocations that could not be served by a free block
+	};
+
+	// Allocates at least size bytes for the subsystem.
+	// Small allocations are rounded up to a power of two and reuse freed blocks of that size.
+	// Thread safe.
+	void* allocate(size_t size, Subsystem subsystem);
+
+	// Frees memory returned by allocate.
+	// The size and subsystem must be the same as they were for allocate.
+	// Thread safe.
+	void deallocate(void* memory, size_t size, Subsystem subsystem);
+
+	// Records memory the subsystem has allocated or freed without going through allocate,
+	// e.g. memory handed out from a block it allocated earlier
+	void recordAllocation(Subsystem subsystem, size_t size, bool isHeapAllocation);
+	void recordDeallocation(Subsystem subsystem, size_t size);
+
+	// Returns the statistics for the subsystem
+	Stats getStats(Subsystem subsystem);
+
+	// Returns the name of the subsystem, for reporting
+	const char* getSubsystemName(Subsystem subsystem);
+
+	// Writes a table of the statistics for every subsystem
+	void printStats(std::ostream& out);
+}
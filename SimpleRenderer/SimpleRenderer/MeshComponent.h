@@ -20,9 +20,13 @@
 
 #include <vector>
 
+// Every mesh is suballocated from the same vertex and index buffers,
+// so a mesh is the range of indices it was given in them
 struct MeshComponent {
-	GLuint VAO;
+	GLuint VAO; // Shared by every mesh
 	GLsizei numIndices;
+	GLuint firstIndex;
+	GLint baseVertex; // Added to each index to find the mesh's vertices
 	const std::vector<VertexFormat>* vertices;
 	const std::vector<GLuint>* indices;
 };
\ No newline at end of file
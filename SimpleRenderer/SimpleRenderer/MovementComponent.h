@@ -13,6 +13,7 @@
 
 #pragma once
 
+// Speeds are per simulation step, which has a fixed length
 struct MovementComponent {
 	float moveSpeed;
 	float orientationSensitivity;
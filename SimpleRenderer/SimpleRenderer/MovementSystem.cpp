@@ -19,29 +19,35 @@
 #include "MovementComponent.h"
 #include "GLUtils.h"
 #include "GLMUtils.h"
+#include "JobSystem.h"
 #include "Scene.h"
 
 #include <glm\glm.hpp>
-#include <glm\gtc\matrix_transform.hpp>
-#include <glm\gtx\rotate_vector.hpp>
+#include <glm\gtc\quaternion.hpp>
 
 #include <cmath>
 
-MovementSystem::MovementSystem(Scene & scene)
+MovementSystem::MovementSystem(Scene & scene, JobSystem& jobSystem)
 	: m_scene{ scene }
+	, m_jobSystem{ jobSystem }
 {
 }
 
-void MovementSystem::update(size_t entityID)
+void MovementSystem::update(EntitySpan entities)
 {
-	// Filter movable
-	const size_t kMovableMask = COMPONENT_MOVEMENT | COMPONENT_INPUT | COMPONENT_TRANSFORM;
-	if ((m_scene.componentMasks.at(entityID) & kMovableMask) != kMovableMask)
-		return;
+	m_jobSystem.parallelFor(entities.size(), kGrainSize, [this, entities](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			updateEntity(entities[i]);
+	});
+}
 
-	glm::mat4& transform = m_scene.transformComponents.at(entityID);
-	MovementComponent& movementVars = m_scene.movementComponents.at(entityID);
-	InputComponent& input = m_scene.inputComponents.at(entityID);
+void MovementSystem::updateEntity(size_t entityID)
+{
+	TransformStorage& transforms = m_scene.transformComponents;
+	const MovementComponent& movementVars = m_scene.movementComponents.at(entityID);
+	const InputComponent& input = m_scene.inputComponents.at(entityID);
+	glm::vec3 pos = transforms.getPosition(entityID);
+	glm::quat rotation = transforms.getRotation(entityID);
 
 	float moveSpeed = movementVars.moveSpeed;
 	float orientationSensitivity = movementVars.orientationSensitivity;
@@ -51,27 +57,28 @@ void MovementSystem::update(size_t entityID)
 	float roll = -orientationSensitivity * input.orientationDelta.z;
 	glm::vec3 front = glm::vec3{ 0, 0, -1 };
 	if (!movementVars.worldSpaceMove)
-		front = transform * glm::vec4{ front, 0 }; // Convert movement to local coordinates
-	glm::vec3 pos = transform[3];
+		front = rotation * front; // Convert movement to local coordinates
 	glm::vec3 up = glm::vec3{ 0, 1, 0 };
 	glm::vec3 right = glm::cross(front, up);
 	
 	// Displacement
 	glm::vec3 axis = GLMUtils::limitVec(input.axis, 1);
 	if (!movementVars.worldSpaceMove)
-		axis = transform * glm::vec4{ axis, 0 }; // Convert movement to local coordinates
+		axis = rotation * axis; // Convert movement to local coordinates
 	pos += moveSpeed * axis;
 
 	// Rotation
 	// Prevent elevation going past 90 degrees
-	glm::mat3 elevationMat{ 1 };
+	glm::quat elevationRotation{ 1, 0, 0, 0 };
 	float elevation = static_cast<float>(M_PI / 2 - std::acos(glm::dot(front, up)));
 	if (std::abs(elevation + deltaElevation) < M_PI / 2)
-		elevationMat = glm::rotate(deltaElevation, right);
-	glm::mat3 azimuthMat = glm::rotate(deltaAzimuth, up);
-	glm::mat3 rollMat = glm::rotate(roll, front);
+		elevationRotation = glm::angleAxis(deltaElevation, glm::normalize(right));
+	glm::quat azimuthRotation = glm::angleAxis(deltaAzimuth, up);
+	glm::quat rollRotation = glm::angleAxis(roll, front);
+
+	// Rotate in world space, renormalizing so that error doesn't build up over time
+	rotation = glm::normalize(rollRotation * azimuthRotation * elevationRotation * rotation);
 
-	transform[3] = {0, 0, 0, 1}; // Remove displacement temporarily
-	transform = glm::mat4{ rollMat * azimuthMat * elevationMat } * transform; // Rotation without displacement
-	transform[3] = glm::vec4{ pos, 1 }; // Add displacement back in
+	transforms.setPosition(entityID, pos);
+	transforms.setRotation(entityID, rotation);
 }
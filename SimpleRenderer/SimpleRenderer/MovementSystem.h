@@ -14,15 +14,34 @@
 
 #pragma once
 
-struct Scene;
+#include "Scene.h"
+
+class JobSystem;
 
 class MovementSystem {
 public:
-	MovementSystem(Scene& scene);
+	MovementSystem(Scene& scene, JobSystem& jobSystem);
+
+	// The components an entity needs to be moved by input
+	static const size_t kComponentMask = COMPONENT_MOVEMENT | COMPONENT_INPUT | COMPONENT_TRANSFORM;
+
+	// The components used by update, for scheduling
+	static const size_t kReadMask = COMPONENT_MOVEMENT | COMPONENT_INPUT | COMPONENT_TRANSFORM;
+	static const size_t kWriteMask = COMPONENT_TRANSFORM;
+	static const bool kMainThreadOnly = false;
 
-	// Updates the entities position from input
-	void update(size_t entityID);
+	// Updates the entities positions from input.
+	// The entities must have the components in kComponentMask.
+	// Entities are updated in parallel on the job system.
+	void update(EntitySpan entities);
 
 private:
+	// The number of entities updated by each job
+	static const size_t kGrainSize = 256;
+
+	// Updates a single entity's position from input
+	void updateEntity(size_t entityID);
+
 	Scene& m_scene;
+	JobSystem& m_jobSystem;
 };
\ No newline at end of file
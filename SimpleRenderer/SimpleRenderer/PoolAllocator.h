@@ -0,0 +1,65 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A standard library allocator that allocates from the
+//                shared memory pool, counting the memory against a subsystem.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include "Memory.h"
+
+#include <cstddef>
+#include <vector>
+
+template <typename T, Memory::Subsystem kSubsystem>
+class PoolAllocator {
+public:
+	using value_type = T;
+
+	// Needed as the subsystem stops std::allocator_traits from rebinding automatically
+	template <typename U>
+	struct rebind {
+		using other = PoolAllocator<U, kSubsystem>;
+	};
+
+	PoolAllocator() = default;
+
+	template <typename U>
+	PoolAllocator(const PoolAllocator<U, kSubsystem>&)
+	{ }
+
+	T* allocate(size_t count)
+	{
+		return static_cast<T*>(Memory::allocate(count * sizeof(T), kSubsystem));
+	}
+
+	void deallocate(T* memory, size_t count)
+	{
+		Memory::deallocate(memory, count * sizeof(T), kSubsystem);
+	}
+};
+
+// All pool allocators share the same pool, so memory from one can be freed by any other
+template <typename T, typename U, Memory::Subsystem kSubsystem>
+bool operator==(const PoolAllocator<T, kSubsystem>&, const PoolAllocator<U, kSubsystem>&)
+{
+	return true;
+}
+
+template <typename T, typename U, Memory::Subsystem kSubsystem>
+bool operator!=(const PoolAllocator<T, kSubsystem>&, const PoolAllocator<U, kSubsystem>&)
+{
+	return false;
+}
+
+// A vector whose memory comes from the pool and is counted against the subsystem
+template <typename T, Memory::Subsystem kSubsystem>
+using PoolVector = std::vector<T, PoolAllocator<T, kSubsystem>>;
@@ -0,0 +1,120 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Orders a frame's draws so that draws sharing GL state
+//                are submitted together.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "RenderQueue.h"
+
+#include "RenderState.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+	// Bits given to each part of a key.
+	// GL names wider than their field wrap around, which only costs batching, not correctness.
+	// Meshes share a VAO, so they are keyed by where their indices start.
+	const unsigned kPassBits = 2;
+	const unsigned kShaderBits = 12;
+	const unsigned kTextureBits = 16;
+	const unsigned kMeshBits = 16;
+	const unsigned kDepthBits = 18;
+	static_assert(kPassBits + kShaderBits + kTextureBits + kMeshBits + kDepthBits == 64, "Sort key fields must fill 64 bits");
+
+	// The radix sort looks at a byte of the key per pass
+	const unsigned kRadixBits = 8;
+	const size_t kNumBuckets = static_cast<size_t>(1) << kRadixBits;
+	const unsigned kNumRadixPasses = 64 / kRadixBits;
+
+	uint64_t getField(uint64_t value, unsigned numBits)
+	{
+		return value & ((static_cast<uint64_t>(1) << numBits) - 1);
+	}
+
+	// Returns the depth scaled to the whole range of the depth field
+	uint64_t quantizeDepth(float depth, float maxDepth)
+	{
+		float normalized = std::min(std::max(depth / maxDepth, 0.0f), 1.0f);
+		return static_cast<uint64_t>(normalized * ((static_cast<uint64_t>(1) << kDepthBits) - 1));
+	}
+}
+
+RenderQueue::Pass RenderQueue::getPass(const RenderObject& object)
+{
+	if (object.material.isTransparent)
+		return PASS_TRANSPARENT;
+	if (!object.material.enableDepth)
+		return PASS_BACKGROUND;
+	return PASS_OPAQUE;
+}
+
+uint64_t RenderQueue::makeSortKey(const RenderObject& object, float maxDepth)
+{
+	Pass pass = getPass(object);
+	uint64_t depth = quantizeDepth(object.depth, maxDepth);
+	uint64_t state = getField(object.material.shader, kShaderBits);
+	state = (state << kTextureBits) | getField(object.material.texture, kTextureBits);
+	state = (state << kMeshBits) | getField(object.mesh.firstIndex, kMeshBits);
+
+	uint64_t key = pass;
+	if (pass == PASS_TRANSPARENT) {
+		// Far objects first, so blending sees what is behind them
+		uint64_t farDepth = getField(~depth, kDepthBits);
+		key = (key << kDepthBits) | farDepth;
+		key = (key << (kShaderBits + kTextureBits + kMeshBits)) | state;
+	}
+	else {
+		// Near objects first within a batch, so the depth test rejects more of what is behind them
+		key = (key << (kShaderBits + kTextureBits + kMeshBits)) | state;
+		key = (key << kDepthBits) | depth;
+	}
+
+	return key;
+}
+
+void RenderQueue::sort(DrawPacket* packets, DrawPacket* scratch, size_t count)
+{
+	// Count every byte of every key in one read of the packets
+	std::array<std::array<size_t, kNumBuckets>, kNumRadixPasses> counts{};
+	for (size_t i = 0; i < count; ++i) {
+		for (unsigned pass = 0; pass < kNumRadixPasses; ++pass)
+			++counts[pass][(packets[i].sortKey >> (pass * kRadixBits)) & (kNumBuckets - 1)];
+	}
+
+	// Least significant byte first, each pass being stable
+	DrawPacket* source = packets;
+	DrawPacket* destination = scratch;
+	for (unsigned pass = 0; pass < kNumRadixPasses; ++pass) {
+		std::array<size_t, kNumBuckets>& buckets = counts[pass];
+
+		// Keys that all share this byte are already in order by it
+		if (std::find(buckets.begin(), buckets.end(), count) != buckets.end())
+			continue;
+
+		size_t offset = 0;
+		for (size_t& bucket : buckets) {
+			size_t bucketSize = bucket;
+			bucket = offset;
+			offset += bucketSize;
+		}
+
+		for (size_t i = 0; i < count; ++i) {
+			size_t bucket = (source[i].sortKey >> (pass * kRadixBits)) & (kNumBuckets - 1);
+			destination[buckets[bucket]++] = source[i];
+		}
+		std::swap(source, destination);
+	}
+
+	if (source != packets)
+		std::memcpy(packets, source, count * sizeof(DrawPacket));
+}
@@ -0,0 +1,54 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Orders a frame's draws so that draws sharing GL state
+//                are submitted together.
+//                Each draw gets a 64 bit key, from most to least significant:
+//                  Opaque:      pass | shader | texture | mesh | depth, front to back
+//                  Transparent: pass | depth, back to front | shader | texture | mesh
+//                so sorting by key groups opaque draws by state, and draws
+//                transparent ones in the order blending needs.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct RenderObject;
+
+// A draw waiting to be submitted
+struct DrawPacket {
+	uint64_t sortKey;
+	const RenderObject* object;
+};
+
+namespace RenderQueue {
+	// The passes a frame is drawn in, in order.
+	// The background, like the skybox, is drawn after the opaque objects so
+	// it is only shaded where nothing covers it.
+	enum Pass {
+		PASS_OPAQUE,
+		PASS_BACKGROUND,
+		PASS_TRANSPARENT
+	};
+
+	// Returns the pass the object is drawn in
+	Pass getPass(const RenderObject& object);
+
+	// Returns the key the object is sorted by.
+	// Depths beyond maxDepth sort as if they were at maxDepth.
+	uint64_t makeSortKey(const RenderObject& object, float maxDepth);
+
+	// Sorts the packets by key in linear time.
+	// Packets with equal keys keep their order.
+	// scratch must have room for count packets, its contents are overwritten.
+	void sort(DrawPacket* packets, DrawPacket* scratch, size_t count);
+}
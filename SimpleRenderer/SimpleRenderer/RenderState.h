@@ -0,0 +1,55 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A copy of everything the renderer needs from the scene
+//                for one frame, so the frame can be drawn while the
+//                simulation is already updating the scene for the next one.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include "MaterialComponent.h"
+#include "MeshComponent.h"
+#include "PoolAllocator.h"
+
+#include <glm\glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// A renderable entity as it was when the state was extracted
+struct RenderObject {
+	size_t entityID;
+	glm::mat4 model;
+	glm::mat4 previousModel; // The model before the last simulation step
+	MeshComponent mesh;
+	MaterialComponent material;
+	float depth; // Distance from the camera
+
+	// The frames the transform and material last changed on,
+	// so the renderer can skip uploading unchanged data
+	uint32_t transformChangedFrame;
+	uint32_t materialChangedFrame;
+};
+
+struct RenderState {
+	uint32_t frame;     // The scene frame the state was extracted on
+	size_t entityCount; // The number of entity IDs in use by the scene
+
+	// How far to draw the objects between their previous and current transforms, from 0 to 1
+	float interpolation;
+
+	bool hasCamera;
+	size_t cameraEntity;
+	glm::mat4 cameraTransform;
+	glm::mat4 previousCameraTransform;
+
+	PoolVector<RenderObject, Memory::MEMORY_RENDER_STATE> objects;
+};
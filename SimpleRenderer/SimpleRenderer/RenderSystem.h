@@ -13,54 +13,67 @@
 
 #pragma once
 
+#include "FrameArena.h"
+#include "RenderQueue.h"
+#include "RenderState.h"
 #include "Scene.h"
+#include "UniformFormat.h"
 
 #include <glad\glad.h>
 #include <glm\glm.hpp>
 
-#include <queue>
+#include <vector>
 
 struct Scene;
 struct GLFWwindow;
-
-class CompareDepth {
-public:
-	CompareDepth() {}
-	CompareDepth(const Scene* scene, const glm::vec3& cameraPos)
-		: m_scene{ scene }
-		, m_cameraPos{ cameraPos }
-	{ }
-
-	bool operator()(size_t entityID1, size_t entityID2) {
-		// return "true" if "entity1" is ordered before "entity2", for example:
-		glm::vec3 entity1Pos = m_scene->transformComponents[entityID1][3];
-		glm::vec3 entity2Pos = m_scene->transformComponents[entityID2][3];
-		float entity1Depth = glm::length(entity1Pos - m_cameraPos);
-		float entity2Depth = glm::length(entity2Pos - m_cameraPos);
-
-		return entity1Depth < entity2Depth;
-	}
-
-private:
-	const Scene* m_scene;
-	glm::vec3 m_cameraPos;
+class JobSystem;
+
+// What drawing the last frame cost
+struct RenderStats {
+	size_t numDraws;             // Multi draw calls, each of which can draw several meshes
+	size_t numCommands;          // Meshes drawn, each with any number of instances
+	size_t numInstances;         // Objects drawn, several of which can share a mesh's draw
+	size_t numStateChanges;      // Shader, texture and vertex array binds made
+	size_t numStateChangesSaved; // Binds skipped as the draw before had already made them
 };
 
 class RenderSystem {
 public:
-	RenderSystem(GLFWwindow* glContext, Scene&);
+	RenderSystem(GLFWwindow* glContext, Scene&, JobSystem& jobSystem);
 	RenderSystem(const RenderSystem&) = delete;
 	RenderSystem& operator=(const RenderSystem&) = delete;
 
-	// Starts rendering the frame.
-	// Should be called before update.
-	void beginRender();
+	// The components an entity needs to be rendered
+	static const size_t kComponentMask = COMPONENT_MESH | COMPONENT_MATERIAL;
+
+	// The components used by update, for scheduling.
+	// update only copies the scene, so it can run on any thread.
+	static const size_t kReadMask = COMPONENT_TRANSFORM | COMPONENT_MESH | COMPONENT_MATERIAL;
+	static const size_t kWriteMask = COMPONENT_NONE;
+	static const bool kMainThreadOnly = false;
 
-	// Renders an entity.
-	void update(size_t entityID);
+	// Copies what is needed to render the entities into the back render state.
+	// The entities must have the components in kComponentMask.
+	// The state is built in parallel on the job system.
+	void update(EntitySpan entities);
 
-	// Ends the frame.
-	void endRender();
+	// Sets how far between the last two simulation steps the states built by
+	// later updates are drawn, from 0 (the previous step) to 1 (the last step).
+	void setInterpolation(float interpolation);
+
+	// Renders the front render state and presents it.
+	// Only reads the render state, not the scene, so it can run while the
+	// simulation updates the scene for the next frame.
+	// Per entity uniforms are only uploaded when the components they come from have changed.
+	// Must be called from the thread that owns the GL context.
+	void render();
+
+	// Returns the stats for the last frame drawn by render
+	const RenderStats& getStats() const;
+
+	// Makes the state built by the last update the one drawn by render.
+	// Must be called while neither update nor render are running.
+	void swapRenderStates();
 
 	// Sets the current camera.
 	void setCamera(size_t entityID);
@@ -70,16 +83,118 @@ public:
 
 	bool mousePick(const glm::dvec2& mousePos, size_t& outEntityID) const;
 private:
+	// The number of render objects built by each job
+	static const size_t kGrainSize = 256;
+
+	// Uploads the uniforms shared by every draw in the frame, like the camera,
+	// and binds them and the object slots for the whole frame
+	void beginRender(const RenderState& state);
+
+	// A draw read from the command buffer by glMultiDrawElementsIndirect, in the layout it expects
+	struct DrawCommand {
+		GLuint numIndices;
+		GLuint numInstances;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance; // Where the draw's entity IDs start in the instance buffer
+	};
+
+	// Objects drawn with a single multi draw.
+	// They share every state but the mesh, and each run of the same mesh is one instanced command.
+	struct DrawBatch {
+		const RenderObject* object; // The first object, whose state the batch is drawn with
+		size_t firstCommand;
+		size_t numCommands;
+		size_t numInstances;
+		size_t outlineCommand; // The command drawing the outline slot, if the object has an outline
+	};
+
+	// Copies a single entity into a render object
+	RenderObject makeRenderObject(size_t entityID, const glm::vec3& cameraPos) const;
+
+	// Updates the slots of objects whose transform or material has changed,
+	// then uploads the range of slots that changed in one call per buffer
+	void uploadObjects(const RenderState& state);
+
+	// Groups runs of sorted draws that share state into batches, with a command for each run of the same mesh,
+	// then uploads the commands and the entity IDs of every command's instances
+	void buildBatches(const FrameVector<DrawPacket>& queue, FrameVector<DrawBatch>& outBatches);
+
+	// Replaces the contents of a buffer that is rewritten every frame, growing it if needed.
+	// The old contents are orphaned, so the driver doesn't wait for last frame's draws to finish with them.
+	static void uploadFrameBuffer(GLenum target, GLuint buffer, size_t& capacity, const void* data, size_t size);
+
+	// Binds GL state, unless the last draw left it bound
+	void useShader(GLuint shader);
+	void bindTexture(GLenum textureType, GLuint texture);
+	void bindVertexArray(GLuint VAO);
+
+	// Renders a batch of objects with one multi draw.
+	// The outline pass draws the object scaled up with the outline shader.
+	void renderBatch(const DrawBatch& batch, bool isOutlinePass = false);
+
+	// Grows the storage buffers so that every entity ID has a slot.
+	// Growing the buffers discards their contents, so every slot is uploaded again.
+	void ensureSlotCapacity(size_t numSlots);
+
+	// Returns true if the objects can be drawn by the same instanced command
+	static bool canInstance(const RenderObject& lhs, const RenderObject& rhs);
+
+	// Returns true if the objects can be drawn by the same multi draw, even with different meshes
+	static bool canMultiDraw(const RenderObject& lhs, const RenderObject& rhs);
+
+	// Returns a transform part way from previous to current, 0 being previous and 1 current
+	static glm::mat4 interpolate(const glm::mat4& previous, const glm::mat4& current, float interpolation);
+
+	// Returns the data for an object drawn with the model matrix
+	static ObjectData makeObjectData(const glm::mat4& model);
+
+	// Returns true if data that changed on changedFrame has not been uploaded yet
+	static bool needsUpload(uint32_t changedFrame, uint32_t uploadFrame);
+
 	GLFWwindow* m_glContext;
 	Scene& m_scene;
-	GLuint m_uboUniforms;
-	GLuint m_uboShaderParams;
-	GLuint m_uniformBindingPoint;
-	GLuint m_shaderParamsBindingPoint;
-	size_t m_cameraEntity;
-	std::priority_queue<size_t, std::vector<size_t>, CompareDepth> m_transparentObjects;
+	JobSystem& m_jobSystem;
+	GLuint m_uboFrameUniforms; // Rewritten once per frame
+	GLuint m_ssboObjects; // One slot per entity ID, then the outline slot
+	GLuint m_ssboShaderParams; // One slot per entity ID, then the outline slot
+	GLuint m_instanceBuffer; // The entity IDs of each command's instances, rewritten once per frame
+	GLuint m_commandBuffer; // The commands of each batch, rewritten once per frame
+	EntityHandle m_camera;
+	float m_interpolation;
+
+	// update writes the back state while render reads the front state
+	RenderState m_renderStates[2];
+	size_t m_backState;
+
+	// Holds containers that are only needed while rendering a frame, reset by render
+	FrameArena m_frameArena;
+
+	// The state bound by the last draw.
+	// Forgotten at the start of each frame, as other code may bind between frames.
+	GLuint m_boundShader;
+	GLenum m_boundTextureType;
+	GLuint m_boundTexture;
+	GLuint m_boundVAO;
+	RenderStats m_stats;
+
+	// The number of entity slots. The outline slot comes after them, and is
+	// rewritten for every outline, as the model matrix is scaled up.
+	size_t m_slotCapacity;
+
+	// Copies of the slots, so every changed slot can be uploaded in one call
+	PoolVector<ObjectData, Memory::MEMORY_RENDER_STATE> m_objects;
+	PoolVector<ShaderParams, Memory::MEMORY_RENDER_STATE> m_shaderParams;
+
+	// The frame each slot was last uploaded on, 0 if it has never been uploaded
+	std::vector<uint32_t> m_objectsUploadFrames;
+	std::vector<uint32_t> m_shaderParamsUploadFrames;
+
+	// The bytes the instance and command buffers have room for
+	size_t m_instanceCapacity;
+	size_t m_commandCapacity;
 
 	// Handler to a cube map on the GPU, used for reflections and environmental lighting
 	GLuint m_environmentMap;
 	bool m_isEnvironmentMap;
-};
\ No newline at end of file
+};
@@ -14,77 +14,327 @@
 #include "RenderSystem.h"
 
 #include "GLUtils.h"
+#include "JobSystem.h"
 #include "MaterialComponent.h"
 #include "MeshComponent.h"
 #include "Scene.h"
 #include "UniformFormat.h"
+#include "RenderQueue.h"
 #include "SceneUtils.h"
+#include "ShaderHelper.h"
 
 #include <GLFW\glfw3.h>
+#include <glm\gtc\matrix_inverse.hpp>
 #include <glm\gtc\matrix_transform.hpp>
 #include <glm\gtc\type_ptr.hpp>
 
+#include <algorithm>
+
 using glm::mat4;
 using glm::vec3;
 using glm::vec4;
 
-RenderSystem::RenderSystem(GLFWwindow* glContext, Scene& scene)
+namespace {
+	// The camera's projection
+	const float kFieldOfView = 60.0f;
+	const float kNearPlane = 0.5f;
+	const float kFarPlane = 100.0f;
+}
+
+RenderSystem::RenderSystem(GLFWwindow* glContext, Scene& scene, JobSystem& jobSystem)
 	: m_glContext{ glContext }
 	, m_scene{ scene }
-	, m_uniformBindingPoint{ 0 }
-	, m_shaderParamsBindingPoint{ 1 }
+	, m_jobSystem{ jobSystem }
+	, m_camera{}
+	, m_interpolation{ 1 }
+	, m_renderStates{}
+	, m_backState{ 0 }
+	, m_boundShader{ 0 }
+	, m_boundTextureType{ 0 }
+	, m_boundTexture{ 0 }
+	, m_boundVAO{ 0 }
+	, m_stats{}
+	, m_slotCapacity{ 0 }
+	, m_instanceCapacity{ 0 }
+	, m_commandCapacity{ 0 }
+	, m_environmentMap{ 0 }
+	, m_isEnvironmentMap{ false }
 {
-	// Create buffer for camera parameters
-	glGenBuffers(1, &m_uboUniforms);
-	glBindBufferBase(GL_UNIFORM_BUFFER, m_uniformBindingPoint, m_uboUniforms);
-	glBufferData(GL_UNIFORM_BUFFER, sizeof(UniformFormat), nullptr, GL_DYNAMIC_DRAW);
+	// Buffers for per entity transforms and shader parameters, sized by ensureSlotCapacity
+	glGenBuffers(1, &m_ssboObjects);
+	glGenBuffers(1, &m_ssboShaderParams);
+
+	// Buffers for the draws of each batch and the entity IDs of their instances, sized by buildBatches.
+	// Every mesh shares a VAO, which reads an entity ID per instance from the instance buffer.
+	glGenBuffers(1, &m_instanceBuffer);
+	glGenBuffers(1, &m_commandBuffer);
+	GLUtils::setInstanceBuffer(m_instanceBuffer);
 
-	// Create buffer for shader parameters
-	glGenBuffers(1, &m_uboShaderParams);
-	glBindBufferBase(GL_UNIFORM_BUFFER, m_shaderParamsBindingPoint, m_uboShaderParams);
-	glBufferData(GL_UNIFORM_BUFFER, sizeof(ShaderParams), nullptr, GL_DYNAMIC_DRAW);
+	// Create buffer for the camera, which stays bound for every draw
+	glGenBuffers(1, &m_uboFrameUniforms);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_uboFrameUniforms);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
 
 	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 }
 
-void RenderSystem::beginRender()
+void RenderSystem::update(EntitySpan entities)
+{
+	RenderState& state = m_renderStates[m_backState];
+	state.frame = m_scene.currentFrame;
+	state.entityCount = SceneUtils::getEntityCount(m_scene);
+	state.interpolation = m_interpolation;
+
+	// Nothing can be rendered without a camera.
+	// The camera entity may have been destroyed since it was set.
+	state.hasCamera = SceneUtils::resolveHandle(m_scene, m_camera, state.cameraEntity) 
+	               && m_scene.transformComponents.has(state.cameraEntity);
+	if (!state.hasCamera) {
+		state.objects.clear();
+		return;
+	}
+
+	// World transforms are up to date by the time the render system runs
+	state.cameraTransform = m_scene.transformComponents.getWorld(state.cameraEntity);
+	state.previousCameraTransform = m_scene.transformComponents.getPreviousWorld(state.cameraEntity);
+	vec3 cameraPos = state.cameraTransform[3];
+
+	// Copy the entities in parallel.
+	// Only reads the scene, so ranges can be copied independently.
+	state.objects.resize(entities.size());
+	m_jobSystem.parallelFor(entities.size(), kGrainSize, [this, entities, &state, cameraPos](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			state.objects[i] = makeRenderObject(entities[i], cameraPos);
+	});
+}
+
+void RenderSystem::setInterpolation(float interpolation)
 {
+	m_interpolation = interpolation;
+}
+
+void RenderSystem::render()
+{
+	const RenderState& state = m_renderStates[1 - m_backState];
+
+	// Everything allocated from the arena last frame has gone out of scope
+	m_frameArena.reset();
+
+	m_boundShader = 0;
+	m_boundTextureType = 0;
+	m_boundTexture = 0;
+	m_boundVAO = 0;
+	m_stats = {};
+
 	glDepthMask(GL_TRUE);
 
 	glStencilMask(0xFF);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-	glm::vec3 cameraPos = m_scene.transformComponents.at(m_cameraEntity)[3];
-	m_transparentObjects = std::priority_queue<size_t, std::vector<size_t>, CompareDepth>(
-		CompareDepth(&m_scene, cameraPos)
-	);
+	if (state.hasCamera) {
+		ensureSlotCapacity(state.entityCount);
+		beginRender(state);
+
+		// The environment map is the same for every draw, so it is bound once
+		if (m_isEnvironmentMap) {
+			glActiveTexture(GL_TEXTURE0 + kEnvironmentSamplerTextureUnit);
+			glBindTexture(GL_TEXTURE_CUBE_MAP, m_environmentMap);
+		}
+		glActiveTexture(GL_TEXTURE0 + kSamplerTextureUnit);
+
+		uploadObjects(state);
+
+		// Sort the draws so those sharing state are submitted together.
+		// Opaque objects are drawn first, then transparent objects from back to front.
+		ArenaAllocator<DrawPacket> allocator{ m_frameArena };
+		FrameVector<DrawPacket> queue{ allocator };
+		queue.reserve(state.objects.size());
+		for (const RenderObject& object : state.objects)
+			queue.push_back(DrawPacket{ RenderQueue::makeSortKey(object, kFarPlane), &object });
+		FrameVector<DrawPacket> scratch{ queue.size(), DrawPacket{}, allocator };
+		RenderQueue::sort(queue.data(), scratch.data(), queue.size());
+
+		// Neighbouring draws that share state are drawn as instances of one draw
+		FrameVector<DrawBatch> batches{ ArenaAllocator<DrawBatch>{ m_frameArena } };
+		buildBatches(queue, batches);
+		for (const DrawBatch& batch : batches)
+			renderBatch(batch);
+	}
+
+	glfwSwapBuffers(m_glContext);
 }
 
-void RenderSystem::endRender()
+void RenderSystem::beginRender(const RenderState& state)
 {
-	while (m_transparentObjects.size() > 0) {
-		update(m_transparentObjects.top());
-		m_transparentObjects.pop();
+	// Get Aspect ratio
+	int width, height;
+	glfwGetFramebufferSize(m_glContext, &width, &height);
+	float aspectRatio = static_cast<float>(width) / height;
+
+	mat4 cameraTransform = interpolate(state.previousCameraTransform, state.cameraTransform, state.interpolation);
+	FrameUniforms uniforms = {};
+	uniforms.view = glm::inverse(cameraTransform);
+	uniforms.projection = glm::perspective(glm::radians(kFieldOfView), aspectRatio, kNearPlane, kFarPlane);
+	uniforms.viewProjection = uniforms.projection * uniforms.view;
+	uniforms.cameraPos = cameraTransform[3];
+	uniforms.time = static_cast<float>(glfwGetTime());
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_uboFrameUniforms);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &uniforms);
+	glBindBufferBase(GL_UNIFORM_BUFFER, kFrameUniformsBindingPoint, m_uboFrameUniforms);
+
+	// Every batch reads its objects from the same slots
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kObjectsBindingPoint, m_ssboObjects);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kShaderParamsBindingPoint, m_ssboShaderParams);
+}
+
+const RenderStats& RenderSystem::getStats() const
+{
+	return m_stats;
+}
+
+void RenderSystem::swapRenderStates()
+{
+	m_backState = 1 - m_backState;
+}
+
+RenderObject RenderSystem::makeRenderObject(size_t entityID, const vec3& cameraPos) const
+{
+	RenderObject object;
+	object.entityID = entityID;
+	object.mesh = m_scene.meshComponents[entityID];
+	object.material = m_scene.materialComponents[entityID];
+	object.transformChangedFrame = SceneUtils::getChangedFrame(m_scene, entityID, COMPONENT_TRANSFORM);
+	object.materialChangedFrame = SceneUtils::getChangedFrame(m_scene, entityID, COMPONENT_MATERIAL);
+
+	// Entities without a transform are at the origin
+	bool hasTransform = (m_scene.componentMasks[entityID] & COMPONENT_TRANSFORM) == COMPONENT_TRANSFORM;
+	object.model = hasTransform ? m_scene.transformComponents.getWorld(entityID) : mat4{ 1 };
+	object.previousModel = hasTransform ? m_scene.transformComponents.getPreviousWorld(entityID) : mat4{ 1 };
+	object.depth = glm::length(vec3{ object.model[3] } - cameraPos);
+
+	return object;
+}
+
+void RenderSystem::uploadObjects(const RenderState& state)
+{
+	size_t firstObject = m_slotCapacity;
+	size_t lastObject = 0;
+	size_t firstShaderParams = m_slotCapacity;
+	size_t lastShaderParams = 0;
+	for (const RenderObject& object : state.objects) {
+		size_t entityID = object.entityID;
+
+		// Moving objects are drawn part way between steps, so their slot is rewritten every frame.
+		// An in between model is replaced next frame, even if the object has stopped.
+		uint32_t& objectUploadFrame = m_objectsUploadFrames[entityID];
+		bool isMoving = object.model != object.previousModel;
+		if (isMoving || needsUpload(object.transformChangedFrame, objectUploadFrame)) {
+			mat4 model = isMoving ? interpolate(object.previousModel, object.model, state.interpolation) : object.model;
+			m_objects[entityID] = makeObjectData(model);
+			objectUploadFrame = isMoving ? 0 : state.frame;
+			firstObject = std::min(firstObject, entityID);
+			lastObject = std::max(lastObject, entityID);
+		}
+
+		uint32_t& shaderParamsUploadFrame = m_shaderParamsUploadFrames[entityID];
+		if (needsUpload(object.materialChangedFrame, shaderParamsUploadFrame)) {
+			m_shaderParams[entityID] = object.material.shaderParams;
+			shaderParamsUploadFrame = state.frame;
+			firstShaderParams = std::min(firstShaderParams, entityID);
+			lastShaderParams = std::max(lastShaderParams, entityID);
+		}
 	}
 
-	glfwSwapBuffers(m_glContext);
+	// Unchanged slots between changed ones are uploaded too, their copies are still current
+	if (firstObject <= lastObject) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ssboObjects);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, firstObject * sizeof(ObjectData),
+			(lastObject - firstObject + 1) * sizeof(ObjectData), &m_objects[firstObject]);
+	}
+	if (firstShaderParams <= lastShaderParams) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ssboShaderParams);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, firstShaderParams * sizeof(ShaderParams),
+			(lastShaderParams - firstShaderParams + 1) * sizeof(ShaderParams), &m_shaderParams[firstShaderParams]);
+	}
 }
 
-void RenderSystem::update(size_t entityID)
+void RenderSystem::buildBatches(const FrameVector<DrawPacket>& queue, FrameVector<DrawBatch>& outBatches)
 {
-	// Filter renderable entities
-	const size_t kRenderableMask = COMPONENT_MESH | COMPONENT_MATERIAL;
-	size_t components = m_scene.componentMasks.at(entityID);
-	if ((m_scene.componentMasks.at(entityID) & kRenderableMask) != kRenderableMask)
+	FrameVector<uint32_t> instances{ ArenaAllocator<uint32_t>{ m_frameArena } };
+	FrameVector<DrawCommand> commands{ ArenaAllocator<DrawCommand>{ m_frameArena } };
+	instances.reserve(queue.size());
+
+	// Adds a command drawing the mesh, whose entity IDs are the next ones added
+	auto addCommand = [&instances, &commands](const MeshComponent& mesh, size_t numInstances) {
+		DrawCommand command;
+		command.numIndices = static_cast<GLuint>(mesh.numIndices);
+		command.numInstances = static_cast<GLuint>(numInstances);
+		command.firstIndex = mesh.firstIndex;
+		command.baseVertex = mesh.baseVertex;
+		command.baseInstance = static_cast<GLuint>(instances.size());
+		commands.push_back(command);
+	};
+
+	size_t first = 0;
+	while (first < queue.size()) {
+		const RenderObject& object = *queue[first].object;
+
+		DrawBatch batch;
+		batch.object = &object;
+		batch.firstCommand = commands.size();
+		batch.numInstances = 0;
+
+		// Every mesh shares the VAO, so runs of different meshes with the same state are drawn together
+		size_t last = first;
+		do {
+			const RenderObject& runObject = *queue[last].object;
+			size_t runEnd = last + 1;
+			while (runEnd < queue.size() && canInstance(runObject, *queue[runEnd].object))
+				++runEnd;
+
+			addCommand(runObject.mesh, runEnd - last);
+			for (size_t i = last; i < runEnd; ++i)
+				instances.push_back(static_cast<uint32_t>(queue[i].object->entityID));
+			batch.numInstances += runEnd - last;
+			last = runEnd;
+		} while (last < queue.size() && canMultiDraw(object, *queue[last].object));
+		batch.numCommands = commands.size() - batch.firstCommand;
+
+		// The outline is drawn from its own slot, as its model is scaled up
+		batch.outlineCommand = 0;
+		if (object.material.hasOutline) {
+			batch.outlineCommand = commands.size();
+			addCommand(object.mesh, 1);
+			instances.push_back(static_cast<uint32_t>(m_slotCapacity));
+		}
+
+		outBatches.push_back(batch);
+		first = last;
+	}
+
+	if (commands.empty())
 		return;
 
-	// Get rendering components of entity
-	MaterialComponent& material = m_scene.materialComponents[entityID];
-	const MeshComponent& mesh = m_scene.meshComponents.at(entityID);
-	mat4& transform = m_scene.transformComponents.at(entityID);
+	// The command buffer stays bound for every batch's draw
+	uploadFrameBuffer(GL_ARRAY_BUFFER, m_instanceBuffer, m_instanceCapacity, instances.data(), instances.size() * sizeof(uint32_t));
+	uploadFrameBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer, m_commandCapacity, commands.data(), commands.size() * sizeof(DrawCommand));
+}
 
-	// TODO: Add check that camera is a valid camera entity, throw error otherwise
-	const mat4& cameraTransform = m_scene.transformComponents.at(m_cameraEntity);
+void RenderSystem::uploadFrameBuffer(GLenum target, GLuint buffer, size_t& capacity, const void* data, size_t size)
+{
+	glBindBuffer(target, buffer);
+	if (size > capacity)
+		capacity = std::max(size, capacity * 2);
+	glBufferData(target, capacity, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(target, 0, size, data);
+}
+
+void RenderSystem::renderBatch(const DrawBatch& batch, bool isOutlinePass)
+{
+	const RenderObject& object = *batch.object;
+	const MaterialComponent& material = object.material;
+	const MeshComponent& mesh = object.mesh;
 
 	if (material.enableDepth) {
 		glCullFace(GL_BACK);
@@ -97,13 +347,18 @@ void RenderSystem::update(size_t entityID)
 		glDepthFunc(GL_LEQUAL);
 	}
 
+	// The outline pass renders the outline in place of the object
+	bool hasOutline = material.hasOutline && !isOutlinePass;
+	bool isOutline = material.isOutline || isOutlinePass;
+	GLuint shader = isOutlinePass ? GLUtils::getOutlineShader() : material.shader;
+
 	// Do Stencil setup for outlined objects
-	if (material.hasOutline) {
+	if (hasOutline) {
 		glEnable(GL_STENCIL_TEST);
 		glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
 		glStencilFunc(GL_ALWAYS, 0xFF, 0xFF);
 	}
-	else if (material.isOutline) {
+	else if (isOutline) {
 		glEnable(GL_STENCIL_TEST);
 		glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 		glStencilFunc(GL_NOTEQUAL, 0xFF, 0xFF);
@@ -112,94 +367,157 @@ void RenderSystem::update(size_t entityID)
 		glDisable(GL_STENCIL_TEST);
 	}
 
-	// Handle transparent objects
-	if (material.isTransparent && m_transparentObjects.size() > 0 && m_transparentObjects.top() == entityID) {
-		// If we are rendering the transparent object queue then enable blending
+	// Handle transparent objects.
+	// These are only rendered once the opaque objects have been drawn.
+	if (material.isTransparent) {
 		glEnable(GL_BLEND);
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	}
-	else if (material.isTransparent) {
-		// If we encounter a transparent object while rendering then defer the render till later
-		m_transparentObjects.push(entityID);
-		return;
-	}
 	else {
 		// Disable blending for opaque objects
 		glDisable(GL_BLEND);
 	}
 
 	// Tell the gpu what material to use
-	glUseProgram(material.shader);
-	glActiveTexture(GL_TEXTURE0);
-	glUniform1i(glGetUniformLocation(material.shader, "sampler"), 0);
-	glBindTexture(material.textureType, material.texture);
-
-	// Set environment map to use on GPU
-	if (m_isEnvironmentMap) {
-		glActiveTexture(GL_TEXTURE1);
-		glUniform1i(glGetUniformLocation(material.shader, "environmentSampler"), 1);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, m_environmentMap);
+	useShader(shader);
+	bindTexture(material.textureType, material.texture);
+
+	// The outline is the object scaled up, written to the outline slot.
+	// Objects with an outline are never batched, so the batch is just the object.
+	size_t firstCommand = batch.firstCommand;
+	size_t numCommands = batch.numCommands;
+	size_t numInstances = batch.numInstances;
+	if (isOutlinePass) {
+		ObjectData outline = makeObjectData(m_objects[object.entityID].model * glm::scale(mat4{}, vec3{ 1.1f, 1.1f, 1.1f }));
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ssboObjects);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, m_slotCapacity * sizeof(ObjectData), sizeof(ObjectData), &outline);
+		firstCommand = batch.outlineCommand;
+		numCommands = 1;
+		numInstances = 1;
 	}
 
-	// Send shader parameters to gpu
-	GLuint blockIndex;
-	blockIndex = glGetUniformBlockIndex(material.shader, "ShaderParams");
-	glUniformBlockBinding(material.shader, blockIndex, m_shaderParamsBindingPoint);
-	glBindBufferBase(GL_UNIFORM_BUFFER, m_shaderParamsBindingPoint, m_uboShaderParams);
-	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ShaderParams), &material.shaderParams);
-		
-	// Get Aspect ratio
-	int width, height;
-	glfwGetFramebufferSize(m_glContext, &width, &height);
-	float aspectRatio = static_cast<float>(width) / height;
+	// Draw the objects, every mesh of the batch in one call
+	bindVertexArray(mesh.VAO);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>(firstCommand * sizeof(DrawCommand)),
+		static_cast<GLsizei>(numCommands), 0);
+	++m_stats.numDraws;
+	m_stats.numCommands += numCommands;
+	m_stats.numInstances += numInstances;
 
-	// Get model, view and projection matrices
-	UniformFormat uniforms;
-	bool hasTransform = (components & COMPONENT_TRANSFORM) ==  COMPONENT_TRANSFORM;
-	uniforms.model = hasTransform ? transform : glm::mat4{ 1 };
-	uniforms.view = glm::inverse(cameraTransform);
-	uniforms.projection = glm::perspective(glm::radians(60.0f), aspectRatio, 0.5f, 100.0f);
-	uniforms.cameraPos = cameraTransform[3];
+	// Handle rendering outline for outlined objects
+	if (hasOutline) {
+		// Render scaled up object with outline shader
+		renderBatch(batch, true);
 
-	// Send the model view and projection matrices to the gpu
-	blockIndex = glGetUniformBlockIndex(material.shader, "Uniforms");
-	glUniformBlockBinding(material.shader, blockIndex, m_uniformBindingPoint);
-	glBindBufferBase(GL_UNIFORM_BUFFER, m_uniformBindingPoint, m_uboUniforms);
-	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(UniformFormat), &uniforms);
+		glClear(GL_STENCIL_BUFFER_BIT);
+	}
+}
 
-	// Draw object
-	glBindVertexArray(mesh.VAO);
-	glDrawElements(GL_TRIANGLES, mesh.numIndices, GL_UNSIGNED_INT, 0);
+void RenderSystem::useShader(GLuint shader)
+{
+	if (shader == m_boundShader) {
+		++m_stats.numStateChangesSaved;
+		return;
+	}
 
-	// Handle rendering outline for outlined objects
-	if (material.hasOutline) {
-		// Save original render state variables
-		GLuint origShader = material.shader;
-		mat4 origTransform = transform;
+	// Samplers and uniform blocks were given fixed bindings when the program was linked
+	glUseProgram(shader);
+	m_boundShader = shader;
+	++m_stats.numStateChanges;
+}
 
-		// Apply outline render state
-		material.shader = GLUtils::getOutlineShader();
-		material.hasOutline = false;
-		material.isOutline = true;
-		transform = transform * glm::scale(mat4{}, vec3{ 1.1f, 1.1f, 1.1f });
+void RenderSystem::bindTexture(GLenum textureType, GLuint texture)
+{
+	if (textureType == m_boundTextureType && texture == m_boundTexture) {
+		++m_stats.numStateChangesSaved;
+		return;
+	}
 
-		// Render scaled up object with outline shader
-		update(entityID);
-		
-		// Restore render state variables
-		material.shader = origShader;
-		material.hasOutline = true;
-		material.isOutline = false;
-		transform = origTransform;
+	glBindTexture(textureType, texture);
+	m_boundTextureType = textureType;
+	m_boundTexture = texture;
+	++m_stats.numStateChanges;
+}
 
-		glClear(GL_STENCIL_BUFFER_BIT);
+void RenderSystem::bindVertexArray(GLuint VAO)
+{
+	if (VAO == m_boundVAO) {
+		++m_stats.numStateChangesSaved;
+		return;
 	}
+
+	glBindVertexArray(VAO);
+	m_boundVAO = VAO;
+	++m_stats.numStateChanges;
+}
+
+void RenderSystem::ensureSlotCapacity(size_t numSlots)
+{
+	if (numSlots <= m_slotCapacity)
+		return;
+
+	// Grow geometrically so that creating entities one at a time doesn't reallocate every frame
+	m_slotCapacity = std::max(numSlots, m_slotCapacity * 2);
+
+	// One extra slot for outlines
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ssboObjects);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (m_slotCapacity + 1) * sizeof(ObjectData), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ssboShaderParams);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (m_slotCapacity + 1) * sizeof(ShaderParams), nullptr, GL_DYNAMIC_DRAW);
+
+	m_objects.resize(m_slotCapacity);
+	m_shaderParams.resize(m_slotCapacity);
+	m_objectsUploadFrames.assign(m_slotCapacity, 0);
+	m_shaderParamsUploadFrames.assign(m_slotCapacity, 0);
+}
+
+bool RenderSystem::canInstance(const RenderObject& lhs, const RenderObject& rhs)
+{
+	return lhs.mesh.firstIndex == rhs.mesh.firstIndex
+	    && lhs.mesh.numIndices == rhs.mesh.numIndices
+	    && lhs.mesh.baseVertex == rhs.mesh.baseVertex
+	    && canMultiDraw(lhs, rhs);
+}
+
+bool RenderSystem::canMultiDraw(const RenderObject& lhs, const RenderObject& rhs)
+{
+	// Outlines are drawn between the object and the next draw, so they can't share a draw
+	const MaterialComponent& lhsMaterial = lhs.material;
+	const MaterialComponent& rhsMaterial = rhs.material;
+	return lhs.mesh.VAO == rhs.mesh.VAO
+	    && lhsMaterial.shader == rhsMaterial.shader
+	    && lhsMaterial.textureType == rhsMaterial.textureType
+	    && lhsMaterial.texture == rhsMaterial.texture
+	    && lhsMaterial.enableDepth == rhsMaterial.enableDepth
+	    && lhsMaterial.isTransparent == rhsMaterial.isTransparent
+	    && lhsMaterial.isOutline == rhsMaterial.isOutline
+	    && !lhsMaterial.hasOutline && !rhsMaterial.hasOutline;
+}
+
+mat4 RenderSystem::interpolate(const mat4& previous, const mat4& current, float interpolation)
+{
+	// Blending the matrices directly is only a close approximation for rotations,
+	// but a single step is small enough that the difference can't be seen
+	return previous + (current - previous) * interpolation;
+}
+
+ObjectData RenderSystem::makeObjectData(const mat4& model)
+{
+	ObjectData object;
+	object.model = model;
+	object.normalMatrix = glm::mat3x4{ glm::inverseTranspose(glm::mat3{ model }) };
+	return object;
+}
+
+bool RenderSystem::needsUpload(uint32_t changedFrame, uint32_t uploadFrame)
+{
+	return uploadFrame == 0 || changedFrame > uploadFrame;
 }
 
 void RenderSystem::setCamera(size_t entityID)
 {
 	// TODO: Throw error if entity does not have a camera component
-	m_cameraEntity = entityID;
+	m_camera = SceneUtils::getHandle(m_scene, entityID);
 }
 
 void RenderSystem::setEnvironmentMap(size_t entityID)
@@ -211,6 +529,10 @@ void RenderSystem::setEnvironmentMap(size_t entityID)
 
 bool RenderSystem::mousePick(const glm::dvec2& mousePos, size_t& outEntityID) const
 {
+	size_t cameraEntity;
+	if (!SceneUtils::resolveHandle(m_scene, m_camera, cameraEntity))
+		return false;
+
 	/**********************************/
 	/** Construct ray in world space **/
 	/**********************************/
@@ -229,14 +551,14 @@ bool RenderSystem::mousePick(const glm::dvec2& mousePos, size_t& outEntityID) co
 	glm::vec4 clipCoords = glm::vec4(mousePosNDC.x, mousePosNDC.y, 1, 1);
 
 	// View space
-	mat4 inverseProj = glm::inverse(glm::perspective(glm::radians(60.0f), aspectRatio, 0.5f, 100.0f));
+	mat4 inverseProj = glm::inverse(glm::perspective(glm::radians(kFieldOfView), aspectRatio, kNearPlane, kFarPlane));
 	glm::vec4 eyeCoords = inverseProj * clipCoords;
 	//eyeCoords /= eyeCoords.w;
 	//eyeCoords.z = -1;
 	eyeCoords.w = 0;
 
 	// World space
-	const mat4& inverseView = m_scene.transformComponents.at(m_cameraEntity);
+	const mat4& inverseView = m_scene.transformComponents.getWorld(cameraEntity);
 	glm::vec4 rayDir4 = inverseView * eyeCoords;
 	glm::vec3 rayDir = rayDir4;
 	rayDir = glm::normalize(rayDir);
@@ -246,16 +568,12 @@ bool RenderSystem::mousePick(const glm::dvec2& mousePos, size_t& outEntityID) co
 	/** Perform raytrace for scene entity **/
 	/***************************************/
 
-	// Perform ray trace for entities
-	for (size_t entityID = 0; entityID < SceneUtils::getEntityCount(m_scene); ++entityID) {
-		// Filter for renderable components
-		const size_t kRenderableMask = COMPONENT_MESH | COMPONENT_MATERIAL;
-		if ((m_scene.componentMasks.at(entityID) & kRenderableMask) != kRenderableMask)
-			continue;
-
+	// Perform ray trace for renderable entities
+	for (size_t entityID : m_scene.view<kComponentMask>()) {
 		auto& indices = *m_scene.meshComponents[entityID].indices;
 		auto& vertices = *m_scene.meshComponents[entityID].vertices;
-		mat4 model = m_scene.transformComponents[entityID];
+		bool hasTransform = m_scene.transformComponents.has(entityID);
+		mat4 model = hasTransform ? m_scene.transformComponents.getWorld(entityID) : mat4{ 1 };
 
 		for (size_t i = 0; i < indices.size(); i += 3) {
 
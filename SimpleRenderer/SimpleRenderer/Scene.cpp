@@ -0,0 +1,34 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A container for all the entities / components in 
+//                scene.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "Scene.h"
+
+const EntityView& Scene::getView(size_t componentMask)
+{
+	auto it = views.find(componentMask);
+	if (it != views.end())
+		return it->second;
+
+	// Build the view from the archetypes that match the mask.
+	// From here on the view is updated whenever a component mask changes.
+	EntityView& view = views.emplace(componentMask, EntityView{ componentMask }).first->second;
+	std::vector<const ArchetypeChunk*> chunks;
+	archetypes.getMatchingChunks(componentMask, chunks);
+	for (const ArchetypeChunk* chunk : chunks) {
+		for (size_t chunkSlot = 0; chunkSlot < chunk->count; ++chunkSlot)
+			view.add(chunk->entities[chunkSlot]);
+	}
+
+	return view;
+}
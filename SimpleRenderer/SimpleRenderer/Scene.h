@@ -14,14 +14,21 @@
 
 #pragma once
 
+#include "Archetype.h"
+#include "EntityView.h"
 #include "InputComponent.h"
 #include "MeshComponent.h"
 #include "MaterialComponent.h"
 #include "MovementComponent.h"
 #include "LogicComponent.h"
+#include "SparseSet.h"
+#include "TransformStorage.h"
 
 #include <glm\glm.hpp>
 
+#include <array>
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 enum ComponentMask {
@@ -37,14 +44,94 @@ enum ComponentMask {
 	COMPONENT_LOGIC = 1 << 8
 };
 
+// The number of bits used by ComponentMask
+const size_t kNumComponentTypes = 9;
+
+// Entities with all of these components spin about their LogicComponent::rotationAxis.
+// SceneUtils keeps the spin axes of their transforms in step with their masks.
+const size_t kSpinComponents = COMPONENT_TRANSFORM | COMPONENT_MESH | COMPONENT_LOGIC;
+
+// A reference to an entity that can detect when the entity has been destroyed.
+// Handles go through the scene's handle table, so they still refer to the
+// same entity after compaction gives it a new ID.
+// A default constructed handle never refers to a live entity.
+struct EntityHandle {
+	size_t index;      // Index into the handle table
+	size_t generation;
+};
+
+// Components are stored in sparse sets so that entities only use memory
+// for the components they actually have.
+// Transforms are stored separately as they form a hierarchy.
 struct Scene {
+	// Use SceneUtils to change component masks so that the archetype index stays up to date
 	std::vector<size_t> componentMasks;
-	std::vector<glm::mat4> transformComponents;
-	std::vector<glm::vec3> velocityComponents;
-	std::vector<glm::vec3> angualarVelocityComponent;
-	std::vector<MeshComponent> meshComponents;
-	std::vector<MaterialComponent> materialComponents;
-	std::vector<MovementComponent> movementComponents;
-	std::vector<InputComponent> inputComponents;
-	std::vector<LogicComponent> logicComponents;
+
+	// Groups entities by component mask, so that a new view only visits the chunks
+	// of matching archetypes rather than testing every entity's mask
+	ArchetypeIndex archetypes;
+
+	// Incremented each time an entity ID is created or destroyed.
+	// Live entities have odd generations, free entity IDs have even generations.
+	std::vector<size_t> entityGenerations;
+
+	// Destroyed entity IDs that can be reused by new entities
+	std::vector<size_t> freeEntityIDs;
+
+	// The handle table, indexed by EntityHandle::index.
+	// Each live entity owns a slot holding its current ID.
+	// Slot generations are incremented when the slot is taken or freed,
+	// so live slots have odd generations.
+	std::vector<size_t> handleEntities;
+	std::vector<size_t> handleGenerations;
+	std::vector<size_t> freeHandles;
+
+	// The handle table slot of each entity ID
+	std::vector<size_t> entityHandles;
+
+	// Incremented at the start of each frame by SceneUtils::advanceFrame
+	uint32_t currentFrame;
+
+	// The frame each component of each entity last changed on.
+	// Indexed by component bit then entity ID.
+	// Each component type has its own array so that systems writing different
+	// components never write to the same memory.
+	// Use SceneUtils::markChanged to update.
+	std::array<std::vector<uint32_t>, kNumComponentTypes> changedFrames;
+
+	TransformStorage transformComponents;
+	SparseSet<glm::vec3> velocityComponents;
+	SparseSet<glm::vec3> angualarVelocityComponent;
+	SparseSet<MeshComponent> meshComponents;
+	SparseSet<MaterialComponent> materialComponents;
+	SparseSet<MovementComponent> movementComponents;
+	SparseSet<InputComponent> inputComponents;
+	SparseSet<LogicComponent> logicComponents;
+
+	// Binding profiles shared by input components, indexed by InputComponent::bindings.
+	// Profile 0 has nothing bound, so new input components ignore the keyboard.
+	// Use SceneUtils::addInputBindings to add profiles.
+	std::vector<InputBindings> inputBindings;
+
+	// Cached entity views, keyed by component mask
+	std::unordered_map<size_t, EntityView> views;
+
+	Scene()
+		: currentFrame{ 1 }
+		, inputBindings(1)
+	{ }
+
+	// Returns the entities that have at least the components in the mask.
+	// The view is built on first use and then kept up to date as 
+	// component masks change.
+	// Not thread safe, as the view may need to be built.
+	// e.g. scene.view<COMPONENT_TRANSFORM | COMPONENT_MESH>()
+	template <size_t kComponentMask>
+	const EntityView& view()
+	{
+		return getView(kComponentMask);
+	}
+
+	// Non template version of view()
+	const EntityView& getView(size_t componentMask);
 };
\ No newline at end of file
@@ -0,0 +1,318 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Builds scenes from text scene descriptions.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "SceneLoader.h"
+
+#include "GLUtils.h"
+#include "Scene.h"
+#include "SceneUtils.h"
+
+#include <glm\gtc\matrix_transform.hpp>
+#include <glm\gtc\quaternion.hpp>
+
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+	// An entity described by one line of a scene file
+	struct EntityDescription {
+		std::string type;
+		glm::vec3 position;
+		glm::quat rotation;
+		glm::vec3 scale{ 1, 1, 1 };
+		float radius = 1;
+		float height = 1;
+		glm::vec3 target;
+		glm::vec3 up{ 0, 1, 0 };
+		std::vector<std::string> faces;
+		bool isStatic = false;
+
+		// Material overrides, only applied if they are in the description
+		bool hasTexture = false;
+		std::string texture;
+		bool hasShader = false;
+		GLuint shader = 0;
+		bool hasMetallicness = false;
+		float metallicness = 0;
+		bool hasGlossiness = false;
+		float glossiness = 0;
+		bool isTransparent = false;
+		bool hasOutline = false;
+	};
+
+	// Reads the properties of a single entity from a line.
+	// Throws std::runtime_error with the location of the error if the line is invalid.
+	class LineParser {
+	public:
+		LineParser(const std::string& line, const std::string& sourceName, size_t lineNumber)
+			: m_tokens{ line }
+			, m_sourceName{ sourceName }
+			, m_lineNumber{ lineNumber }
+		{ }
+
+		// Gets the next token, returns false at the end of the line
+		bool next(std::string& outToken)
+		{
+			return static_cast<bool>(m_tokens >> outToken);
+		}
+
+		std::string readString(const std::string& property)
+		{
+			std::string value;
+			if (!next(value))
+				error("'" + property + "' is missing a value");
+			return value;
+		}
+
+		float readFloat(const std::string& property)
+		{
+			float value;
+			if (!(m_tokens >> value))
+				error("'" + property + "' expects a number");
+			return value;
+		}
+
+		glm::vec3 readVec3(const std::string& property)
+		{
+			float x = readFloat(property);
+			float y = readFloat(property);
+			float z = readFloat(property);
+			return glm::vec3{ x, y, z };
+		}
+
+		void error(const std::string& message) const
+		{
+			throw std::runtime_error("SceneLoader: " + m_sourceName + "(" + std::to_string(m_lineNumber) + "): " + message);
+		}
+
+	private:
+		std::istringstream m_tokens;
+		const std::string& m_sourceName;
+		size_t m_lineNumber;
+	};
+
+	bool isPrimitive(const std::string& type)
+	{
+		return type == "sphere" || type == "cube" || type == "cylinder" || type == "pyramid"
+		    || type == "quad" || type == "skybox" || type == "camera";
+	}
+
+	EntityDescription parseEntity(LineParser& parser, const std::string& type)
+	{
+		if (!isPrimitive(type))
+			parser.error("unknown primitive '" + type + "'");
+
+		EntityDescription entity;
+		entity.type = type;
+
+		std::string property;
+		while (parser.next(property)) {
+			if (property == "position") {
+				entity.position = parser.readVec3(property);
+			}
+			else if (property == "rotation") {
+				float degrees = parser.readFloat(property);
+				glm::vec3 axis = parser.readVec3(property);
+				if (glm::length(axis) == 0)
+					parser.error("'rotation' axis can't be zero");
+				entity.rotation = entity.rotation * glm::angleAxis(glm::radians(degrees), glm::normalize(axis));
+			}
+			else if (property == "scale") {
+				entity.scale = parser.readVec3(property);
+			}
+			else if (property == "radius" && type == "cylinder") {
+				entity.radius = parser.readFloat(property);
+			}
+			else if (property == "height" && type == "cylinder") {
+				entity.height = parser.readFloat(property);
+			}
+			else if (property == "target" && type == "camera") {
+				entity.target = parser.readVec3(property);
+			}
+			else if (property == "up" && type == "camera") {
+				entity.up = parser.readVec3(property);
+			}
+			else if (property == "faces" && type == "skybox") {
+				for (size_t i = 0; i < 6; ++i)
+					entity.faces.push_back(parser.readString(property));
+			}
+			else if (property == "texture") {
+				entity.hasTexture = true;
+				entity.texture = parser.readString(property);
+			}
+			else if (property == "shader") {
+				std::string shaderName = parser.readString(property);
+				if (!GLUtils::getShaderByName(shaderName, entity.shader))
+					parser.error("unknown shader '" + shaderName + "'");
+				entity.hasShader = true;
+			}
+			else if (property == "metallicness") {
+				entity.hasMetallicness = true;
+				entity.metallicness = parser.readFloat(property);
+			}
+			else if (property == "glossiness") {
+				entity.hasGlossiness = true;
+				entity.glossiness = parser.readFloat(property);
+			}
+			else if (property == "transparent") {
+				entity.isTransparent = true;
+			}
+			else if (property == "outline") {
+				entity.hasOutline = true;
+			}
+			else if (property == "static") {
+				entity.isStatic = true;
+			}
+			else {
+				parser.error("unknown property '" + property + "' for " + type);
+			}
+		}
+
+		if (type == "skybox" && entity.faces.empty())
+			parser.error("skybox needs 'faces'");
+
+		return entity;
+	}
+
+	// Gets the primitive type for an entity type.
+	// Returns false if the entity is not a primitive.
+	bool getPrimitiveType(const std::string& type, SceneUtils::PrimitiveType& outPrimitiveType)
+	{
+		if (type == "sphere")
+			outPrimitiveType = SceneUtils::PRIMITIVE_SPHERE;
+		else if (type == "cube")
+			outPrimitiveType = SceneUtils::PRIMITIVE_CUBE;
+		else if (type == "cylinder")
+			outPrimitiveType = SceneUtils::PRIMITIVE_CYLINDER;
+		else if (type == "pyramid")
+			outPrimitiveType = SceneUtils::PRIMITIVE_PYRAMID;
+		else if (type == "quad")
+			outPrimitiveType = SceneUtils::PRIMITIVE_QUAD;
+		else
+			return false;
+		return true;
+	}
+
+	// Returns the transform of a primitive, with a cylinder's size baked in
+	glm::mat4 getTransform(const EntityDescription& description)
+	{
+		glm::mat4 transform = glm::translate(glm::mat4{ 1 }, description.position)
+		                    * glm::mat4_cast(description.rotation)
+		                    * glm::scale(glm::mat4{ 1 }, description.scale);
+		if (description.type == "cylinder")
+			transform = transform * glm::scale(glm::mat4{ 1 }, glm::vec3{ description.radius, description.height, description.radius });
+		return transform;
+	}
+
+	// Applies the overrides from the description to a primitive created with SceneUtils
+	void applyOverrides(Scene& scene, size_t entityID, const EntityDescription& description)
+	{
+		MaterialComponent& material = scene.materialComponents.at(entityID);
+		if (description.hasTexture)
+			material.texture = GLUtils::loadTexture(description.texture);
+		if (description.hasShader)
+			material.shader = description.shader;
+		if (description.hasMetallicness)
+			material.shaderParams.metallicness = description.metallicness;
+		if (description.hasGlossiness)
+			material.shaderParams.glossiness = description.glossiness;
+		material.isTransparent = material.isTransparent || description.isTransparent;
+		material.hasOutline = material.hasOutline || description.hasOutline;
+
+		if (description.isStatic)
+			SceneUtils::removeComponents(scene, entityID, COMPONENT_LOGIC);
+	}
+
+	// Creates the entities, with each run of primitives of the same type created in one batch
+	void createEntities(Scene& scene, const std::vector<EntityDescription>& entities)
+	{
+		std::vector<glm::mat4> transforms;
+		std::vector<size_t> entityIDs;
+		size_t first = 0;
+		while (first < entities.size()) {
+			const EntityDescription& description = entities[first];
+			SceneUtils::PrimitiveType primitiveType;
+			if (!getPrimitiveType(description.type, primitiveType)) {
+				if (description.type == "camera")
+					SceneUtils::createCamera(scene, description.position, description.target, description.up);
+				else
+					SceneUtils::createSkybox(scene, description.faces);
+				++first;
+				continue;
+			}
+
+			size_t last = first + 1;
+			while (last < entities.size() && entities[last].type == description.type)
+				++last;
+
+			transforms.clear();
+			for (size_t i = first; i < last; ++i)
+				transforms.push_back(getTransform(entities[i]));
+
+			entityIDs.clear();
+			SceneUtils::createPrimitives(scene, primitiveType, transforms.data(), transforms.size(), entityIDs);
+			for (size_t i = first; i < last; ++i)
+				applyOverrides(scene, entityIDs[i - first], entities[i]);
+
+			first = last;
+		}
+	}
+}
+
+void SceneLoader::load(Scene& scene, const std::string& filename, JobSystem& jobSystem)
+{
+	std::ifstream file(filename);
+	if (!file)
+		throw std::runtime_error("SceneLoader: could not open " + filename);
+
+	load(scene, file, filename, jobSystem);
+}
+
+void SceneLoader::load(Scene& scene, std::istream& description, const std::string& sourceName, JobSystem& jobSystem)
+{
+	// Every entity is parsed before any is created, so a file with an error adds nothing to the scene
+	std::vector<EntityDescription> entities;
+	std::vector<std::string> textures;
+	std::vector<std::vector<std::string>> cubeMaps;
+	std::set<SceneUtils::PrimitiveType> primitiveTypes;
+	std::string line;
+	for (size_t lineNumber = 1; std::getline(description, line); ++lineNumber) {
+		LineParser parser(line, sourceName, lineNumber);
+		std::string type;
+		if (!parser.next(type) || type[0] == '#')
+			continue;
+
+		entities.push_back(parseEntity(parser, type));
+		const EntityDescription& entity = entities.back();
+		SceneUtils::PrimitiveType primitiveType;
+		if (entity.hasTexture)
+			textures.push_back(entity.texture);
+		if (getPrimitiveType(entity.type, primitiveType))
+			primitiveTypes.insert(primitiveType);
+		if (entity.type == "skybox")
+			cubeMaps.push_back(entity.faces);
+	}
+
+	// Primitives start with their default texture, even if it is overridden
+	for (SceneUtils::PrimitiveType primitiveType : primitiveTypes)
+		textures.push_back(SceneUtils::getPrimitiveTextureFilename(primitiveType));
+
+	// Decode every texture and skybox face at once, in parallel, rather than one at a time as entities are created
+	GLUtils::loadTextures(textures, cubeMaps, jobSystem);
+
+	SceneUtils::reserveEntities(scene, entities.size());
+	createEntities(scene, entities);
+}
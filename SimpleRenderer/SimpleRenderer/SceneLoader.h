@@ -0,0 +1,58 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Builds scenes from text scene descriptions.
+//                Each line describes one entity: a primitive type followed
+//                by any number of properties, e.g.
+//                    cube position 1.5 1.5 0 rotation -11.25 1 0 0 outline
+//                Blank lines and lines starting with # are ignored.
+//
+//                Primitives:
+//                    sphere, cube, cylinder, pyramid, quad, skybox, camera
+//                Transform properties (applied as translation * rotation * scale):
+//                    position x y z
+//                    rotation degrees axisX axisY axisZ (repeatable, applied in order)
+//                    scale x y z
+//                Cylinder properties:
+//                    radius r
+//                    height h
+//                Material properties:
+//                    texture path
+//                    shader default|threshold|outline|water|skybox
+//                    metallicness m
+//                    glossiness g
+//                    transparent
+//                    outline
+//                Other properties:
+//                    static (the entity isn't spun by the gameplay logic)
+//                    faces right left top bottom back front (skybox only)
+//                    target x y z, up x y z (camera only, camera uses position as its eye)
+//                Paths can't contain spaces.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include <istream>
+#include <string>
+
+struct Scene;
+class JobSystem;
+
+namespace SceneLoader {
+	// Adds the entities described by a scene file to the scene.
+	// Entities are created in the order they appear in the file.
+	// Throws std::runtime_error if the file can't be opened or has an error in it,
+	// in which case nothing is added to the scene.
+	void load(Scene& scene, const std::string& filename, JobSystem& jobSystem);
+
+	// As above, but reads the description from a stream.
+	// sourceName is used in error messages.
+	void load(Scene& scene, std::istream& description, const std::string& sourceName, JobSystem& jobSystem);
+}
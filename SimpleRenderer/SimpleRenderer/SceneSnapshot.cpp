@@ -0,0 +1,576 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Saves and loads scenes as binary snapshots.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "SceneSnapshot.h"
+
+#include "GLUtils.h"
+#include "MappedFile.h"
+#include "Scene.h"
+#include "SceneUtils.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+	const char g_kMagic[4] = { 'S', 'R', 'S', 'N' };
+
+	// Sections start on a cache line so that arrays can be read with aligned SIMD loads
+	const uint64_t g_kSectionAlignment = 64;
+
+	enum SectionID : uint32_t {
+		SECTION_ASSET_NAMES,
+		SECTION_COMPONENT_MASKS,
+		SECTION_ENTITY_GENERATIONS,
+		SECTION_FREE_ENTITY_IDS,
+		SECTION_TRANSFORM_ENTITIES,
+		SECTION_TRANSFORM_PARENTS,
+		SECTION_POSITION_X,
+		SECTION_POSITION_Y,
+		SECTION_POSITION_Z,
+		SECTION_ROTATION_X,
+		SECTION_ROTATION_Y,
+		SECTION_ROTATION_Z,
+		SECTION_ROTATION_W,
+		SECTION_SCALE_X,
+		SECTION_SCALE_Y,
+		SECTION_SCALE_Z,
+		SECTION_VELOCITY_ENTITIES,
+		SECTION_VELOCITIES,
+		SECTION_ANGULAR_VELOCITY_ENTITIES,
+		SECTION_ANGULAR_VELOCITIES,
+		SECTION_MESH_ENTITIES,
+		SECTION_MESHES,
+		SECTION_MATERIAL_ENTITIES,
+		SECTION_MATERIALS,
+		SECTION_MOVEMENT_ENTITIES,
+		SECTION_MOVEMENTS,
+		SECTION_INPUT_ENTITIES,
+		SECTION_INPUTS,
+		SECTION_LOGIC_ENTITIES,
+		SECTION_LOGICS,
+		SECTION_INPUT_BINDINGS,
+		SECTION_HANDLE_ENTITIES,
+		SECTION_HANDLE_GENERATIONS,
+		SECTION_FREE_HANDLES,
+		SECTION_ENTITY_HANDLES
+	};
+
+	struct FileHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t numSections;
+		uint32_t reserved;
+	};
+
+	// Describes where a section is in the file.
+	// The element size is checked on load, so snapshots from builds with
+	// different component layouts are rejected rather than misread.
+	struct SectionHeader {
+		uint32_t id;
+		uint32_t elementSize;
+		uint64_t offset;
+		uint64_t count;
+	};
+
+	// Meshes are built in, so they are referred to by name
+	struct NamedMesh {
+		const char* name;
+		MeshComponent(*get)();
+	};
+	const NamedMesh g_kMeshes[] = {
+		{ "quad", &SceneUtils::getQuadMesh },
+		{ "sphere", &SceneUtils::getSphereMesh },
+		{ "cylinder", &SceneUtils::getCylinderMesh },
+		{ "pyramid", &SceneUtils::getPyramidMesh },
+		{ "cube", &SceneUtils::getCubeMesh }
+	};
+
+	// Separates the faces of a cube map in its asset name
+	const char g_kFaceSeparator = '|';
+
+	// Builds the table of asset names while saving.
+	// Index 0 is reserved for components that don't refer to an asset.
+	class AssetTable {
+	public:
+		AssetTable()
+			: m_names{ "" }
+		{ }
+
+		uint32_t addShader(GLuint shader)
+		{
+			if (shader == 0)
+				return 0;
+			std::string name;
+			if (!GLUtils::getShaderName(shader, name))
+				throw std::invalid_argument("SceneSnapshot::save: material uses a shader that is not built in");
+			return add("shader:" + name);
+		}
+
+		uint32_t addTexture(GLuint texture, GLenum textureType)
+		{
+			if (texture == 0)
+				return 0;
+
+			if (textureType == GL_TEXTURE_CUBE_MAP) {
+				std::vector<std::string> faceFilenames;
+				if (!GLUtils::getCubeMapFilenames(texture, faceFilenames))
+					throw std::invalid_argument("SceneSnapshot::save: material uses a cube map that was not loaded from files");
+
+				std::string name = "cubemap:";
+				for (size_t i = 0; i < faceFilenames.size(); ++i) {
+					if (i > 0)
+						name += g_kFaceSeparator;
+					name += faceFilenames[i];
+				}
+				return add(name);
+			}
+
+			std::string filename;
+			if (!GLUtils::getTextureFilename(texture, filename))
+				throw std::invalid_argument("SceneSnapshot::save: material uses a texture that was not loaded from a file");
+			return add("texture:" + filename);
+		}
+
+		uint32_t addMesh(const MeshComponent& mesh)
+		{
+			if (mesh.VAO == 0)
+				return 0;
+
+			// Every mesh shares the VAO, so a mesh is told apart by where its indices start
+			for (const NamedMesh& namedMesh : g_kMeshes) {
+				if (namedMesh.get().firstIndex == mesh.firstIndex)
+					return add(std::string("mesh:") + namedMesh.name);
+			}
+			throw std::invalid_argument("SceneSnapshot::save: mesh is not built in");
+		}
+
+		// Returns the names as length prefixed strings
+		std::vector<char> serialize() const
+		{
+			std::vector<char> bytes;
+			for (const std::string& name : m_names) {
+				uint32_t length = static_cast<uint32_t>(name.size());
+				const char* lengthBytes = reinterpret_cast<const char*>(&length);
+				bytes.insert(bytes.end(), lengthBytes, lengthBytes + sizeof(length));
+				bytes.insert(bytes.end(), name.begin(), name.end());
+			}
+			return bytes;
+		}
+
+	private:
+		uint32_t add(const std::string& name)
+		{
+			auto it = m_indices.find(name);
+			if (it != m_indices.end())
+				return it->second;
+
+			uint32_t index = static_cast<uint32_t>(m_names.size());
+			m_names.push_back(name);
+			m_indices.emplace(name, index);
+			return index;
+		}
+
+		std::vector<std::string> m_names;
+		std::unordered_map<std::string, uint32_t> m_indices;
+	};
+
+	// A GPU resource loaded from the asset table
+	struct LoadedAsset {
+		GLuint handle;
+		MeshComponent mesh; // Only used by meshes
+	};
+
+	// Loads the asset with the name, reusing it if it is already loaded
+	LoadedAsset loadAsset(const std::string& name)
+	{
+		LoadedAsset asset{};
+		if (name.empty())
+			return asset;
+
+		size_t separator = name.find(':');
+		std::string type = name.substr(0, separator);
+		std::string path = (separator == std::string::npos) ? "" : name.substr(separator + 1);
+
+		if (type == "shader") {
+			if (GLUtils::getShaderByName(path, asset.handle))
+				return asset;
+		}
+		else if (type == "mesh") {
+			for (const NamedMesh& namedMesh : g_kMeshes) {
+				if (path == namedMesh.name) {
+					asset.mesh = namedMesh.get();
+					asset.handle = asset.mesh.VAO;
+					return asset;
+				}
+			}
+		}
+		else if (type == "texture") {
+			asset.handle = GLUtils::loadTexture(path);
+			return asset;
+		}
+		else if (type == "cubemap") {
+			std::vector<std::string> faceFilenames;
+			std::stringstream faces(path);
+			std::string face;
+			while (std::getline(faces, face, g_kFaceSeparator))
+				faceFilenames.push_back(face);
+			asset.handle = GLUtils::loadCubeMap(faceFilenames);
+			return asset;
+		}
+
+		throw std::runtime_error("SceneSnapshot::load: unknown asset " + name);
+	}
+
+	// Collects sections and writes them out with the header
+	class SnapshotWriter {
+	public:
+		template <typename T>
+		void addSection(SectionID id, const T* data, size_t count)
+		{
+			m_sections.push_back({ id, sizeof(T), 0, count });
+			m_sectionData.push_back(data);
+		}
+
+		template <typename T, typename Allocator>
+		void addSection(SectionID id, const std::vector<T, Allocator>& data)
+		{
+			addSection(id, data.data(), data.size());
+		}
+
+		void write(const std::string& filename)
+		{
+			std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+			if (!file)
+				throw std::runtime_error("SceneSnapshot::save: could not open " + filename);
+
+			// Lay out the sections after the header and section table
+			uint64_t offset = sizeof(FileHeader) + m_sections.size() * sizeof(SectionHeader);
+			for (SectionHeader& section : m_sections) {
+				offset = alignOffset(offset);
+				section.offset = offset;
+				offset += section.elementSize * section.count;
+			}
+
+			FileHeader header{};
+			std::memcpy(header.magic, g_kMagic, sizeof(g_kMagic));
+			header.version = SceneSnapshot::kVersion;
+			header.numSections = static_cast<uint32_t>(m_sections.size());
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(m_sections.data()), m_sections.size() * sizeof(SectionHeader));
+
+			const char kPadding[g_kSectionAlignment] = {};
+			uint64_t position = sizeof(FileHeader) + m_sections.size() * sizeof(SectionHeader);
+			for (size_t i = 0; i < m_sections.size(); ++i) {
+				const SectionHeader& section = m_sections[i];
+				file.write(kPadding, section.offset - position);
+				file.write(static_cast<const char*>(m_sectionData[i]), section.elementSize * section.count);
+				position = section.offset + section.elementSize * section.count;
+			}
+
+			if (!file)
+				throw std::runtime_error("SceneSnapshot::save: could not write " + filename);
+		}
+
+	private:
+		static uint64_t alignOffset(uint64_t offset)
+		{
+			return (offset + g_kSectionAlignment - 1) / g_kSectionAlignment * g_kSectionAlignment;
+		}
+
+		std::vector<SectionHeader> m_sections;
+		std::vector<const void*> m_sectionData;
+	};
+
+	// Validates and finds sections in a mapped snapshot
+	class SnapshotReader {
+	public:
+		explicit SnapshotReader(const std::string& filename)
+			: m_file{ filename }
+		{
+			FileHeader header;
+			if (m_file.size() < sizeof(header))
+				throw std::runtime_error("SceneSnapshot::load: " + filename + " is not a snapshot");
+			std::memcpy(&header, m_file.data(), sizeof(header));
+			if (std::memcmp(header.magic, g_kMagic, sizeof(g_kMagic)) != 0)
+				throw std::runtime_error("SceneSnapshot::load: " + filename + " is not a snapshot");
+			if (header.version != SceneSnapshot::kVersion)
+				throw std::runtime_error("SceneSnapshot::load: " + filename + " was saved with an unsupported version");
+
+			uint64_t tableSize = static_cast<uint64_t>(header.numSections) * sizeof(SectionHeader);
+			if (m_file.size() - sizeof(header) < tableSize)
+				throw std::runtime_error("SceneSnapshot::load: " + filename + " is truncated");
+			m_sections.resize(header.numSections);
+			std::memcpy(m_sections.data(), m_file.data() + sizeof(header), tableSize);
+
+			for (const SectionHeader& section : m_sections) {
+				if (section.offset > m_file.size() || section.count > (m_file.size() - section.offset) / std::max<uint64_t>(section.elementSize, 1))
+					throw std::runtime_error("SceneSnapshot::load: " + filename + " is truncated");
+			}
+		}
+
+		// Returns the elements of a section, used in place from the mapped file.
+		// Missing sections are empty, so components added in later versions can be skipped.
+		template <typename T>
+		Span<const T> getSection(SectionID id) const
+		{
+			for (const SectionHeader& section : m_sections) {
+				if (section.id != id)
+					continue;
+				if (section.elementSize != sizeof(T) || section.offset % alignof(T) != 0)
+					throw std::runtime_error("SceneSnapshot::load: snapshot was saved with different component layouts");
+				return Span<const T>(reinterpret_cast<const T*>(m_file.data() + section.offset), static_cast<size_t>(section.count));
+			}
+			return Span<const T>();
+		}
+
+		// Returns the sections holding a sparse set's entities and values.
+		// Throws if they are different lengths.
+		template <typename T>
+		void getSparseSetSections(SectionID entitiesID, SectionID valuesID, Span<const size_t>& outEntities, Span<const T>& outValues) const
+		{
+			outEntities = getSection<size_t>(entitiesID);
+			outValues = getSection<T>(valuesID);
+			if (outEntities.size() != outValues.size())
+				throw std::runtime_error("SceneSnapshot::load: component section sizes don't match");
+		}
+
+	private:
+		MappedFile m_file;
+		std::vector<SectionHeader> m_sections;
+	};
+
+	template <typename T>
+	void addSparseSet(SnapshotWriter& writer, SectionID entitiesID, SectionID valuesID, const SparseSet<T>& components)
+	{
+		writer.addSection(entitiesID, components.entities());
+		writer.addSection(valuesID, components.data(), components.size());
+	}
+
+	template <typename T>
+	void loadSparseSet(const SnapshotReader& reader, SectionID entitiesID, SectionID valuesID, SparseSet<T>& outComponents)
+	{
+		Span<const size_t> entities;
+		Span<const T> values;
+		reader.getSparseSetSections(entitiesID, valuesID, entities, values);
+		outComponents.assign(entities.data(), values.data(), entities.size());
+	}
+}
+
+void SceneSnapshot::save(const Scene& scene, const std::string& filename)
+{
+	SnapshotWriter writer;
+
+	writer.addSection(SECTION_COMPONENT_MASKS, scene.componentMasks);
+	writer.addSection(SECTION_ENTITY_GENERATIONS, scene.entityGenerations);
+	writer.addSection(SECTION_FREE_ENTITY_IDS, scene.freeEntityIDs);
+	writer.addSection(SECTION_HANDLE_ENTITIES, scene.handleEntities);
+	writer.addSection(SECTION_HANDLE_GENERATIONS, scene.handleGenerations);
+	writer.addSection(SECTION_FREE_HANDLES, scene.freeHandles);
+	writer.addSection(SECTION_ENTITY_HANDLES, scene.entityHandles);
+
+	// Dead slots left by destroyed entities are skipped, in an order that is still depth first.
+	// The writer only keeps pointers, so the gathered arrays must live until the file is written.
+	const TransformStorage& transforms = scene.transformComponents;
+	std::vector<size_t> transformOrder;
+	transforms.getLiveOrder(transformOrder);
+	auto gather = [&transformOrder](const auto* values) {
+		std::vector<std::remove_const_t<std::remove_pointer_t<decltype(values)>>> live;
+		live.reserve(transformOrder.size());
+		for (size_t index : transformOrder)
+			live.push_back(values[index]);
+		return live;
+	};
+	std::vector<size_t> transformEntities = gather(transforms.entities().data());
+	std::vector<size_t> transformParents = gather(transforms.parents().data());
+	writer.addSection(SECTION_TRANSFORM_ENTITIES, transformEntities);
+	writer.addSection(SECTION_TRANSFORM_PARENTS, transformParents);
+
+	TransformMath::TRSArrays trs = transforms.getTRSArrays();
+	const std::pair<SectionID, const float*> trsSections[] = {
+		{ SECTION_POSITION_X, trs.positionX }, { SECTION_POSITION_Y, trs.positionY }, { SECTION_POSITION_Z, trs.positionZ },
+		{ SECTION_ROTATION_X, trs.rotationX }, { SECTION_ROTATION_Y, trs.rotationY }, { SECTION_ROTATION_Z, trs.rotationZ },
+		{ SECTION_ROTATION_W, trs.rotationW },
+		{ SECTION_SCALE_X, trs.scaleX }, { SECTION_SCALE_Y, trs.scaleY }, { SECTION_SCALE_Z, trs.scaleZ }
+	};
+	std::vector<std::vector<float>> liveTRS;
+	liveTRS.reserve(std::extent<decltype(trsSections)>::value);
+	for (const auto& section : trsSections) {
+		liveTRS.push_back(gather(section.second));
+		writer.addSection(section.first, liveTRS.back());
+	}
+
+	addSparseSet(writer, SECTION_VELOCITY_ENTITIES, SECTION_VELOCITIES, scene.velocityComponents);
+	addSparseSet(writer, SECTION_ANGULAR_VELOCITY_ENTITIES, SECTION_ANGULAR_VELOCITIES, scene.angualarVelocityComponent);
+	addSparseSet(writer, SECTION_MOVEMENT_ENTITIES, SECTION_MOVEMENTS, scene.movementComponents);
+	addSparseSet(writer, SECTION_INPUT_ENTITIES, SECTION_INPUTS, scene.inputComponents);
+	writer.addSection(SECTION_INPUT_BINDINGS, scene.inputBindings);
+	addSparseSet(writer, SECTION_LOGIC_ENTITIES, SECTION_LOGICS, scene.logicComponents);
+
+	// GPU handles and pointers are replaced with indices into the asset table
+	AssetTable assets;
+	std::vector<MeshComponent> meshes(scene.meshComponents.begin(), scene.meshComponents.end());
+	for (MeshComponent& mesh : meshes)
+		mesh = MeshComponent{ assets.addMesh(mesh), mesh.numIndices, 0, 0, nullptr, nullptr };
+	writer.addSection(SECTION_MESH_ENTITIES, scene.meshComponents.entities());
+	writer.addSection(SECTION_MESHES, meshes);
+
+	std::vector<MaterialComponent> materials(scene.materialComponents.begin(), scene.materialComponents.end());
+	for (MaterialComponent& material : materials) {
+		material.shader = assets.addShader(material.shader);
+		material.texture = assets.addTexture(material.texture, material.textureType);
+	}
+	writer.addSection(SECTION_MATERIAL_ENTITIES, scene.materialComponents.entities());
+	writer.addSection(SECTION_MATERIALS, materials);
+
+	std::vector<char> assetNames = assets.serialize();
+	writer.addSection(SECTION_ASSET_NAMES, assetNames);
+
+	writer.write(filename);
+}
+
+void SceneSnapshot::load(Scene& scene, const std::string& filename)
+{
+	SnapshotReader reader(filename);
+
+	// Load the assets first, so a missing asset leaves the scene untouched
+	std::vector<LoadedAsset> assets;
+	Span<const char> assetNames = reader.getSection<char>(SECTION_ASSET_NAMES);
+	for (size_t offset = 0; offset < assetNames.size();) {
+		uint32_t length;
+		if (assetNames.size() - offset < sizeof(length))
+			throw std::runtime_error("SceneSnapshot::load: asset table is truncated");
+		std::memcpy(&length, assetNames.data() + offset, sizeof(length));
+		offset += sizeof(length);
+		if (assetNames.size() - offset < length)
+			throw std::runtime_error("SceneSnapshot::load: asset table is truncated");
+		assets.push_back(loadAsset(std::string(assetNames.data() + offset, length)));
+		offset += length;
+	}
+
+	// Check asset references up front as well
+	Span<const size_t> meshEntities;
+	Span<const MeshComponent> meshes;
+	Span<const size_t> materialEntities;
+	Span<const MaterialComponent> materials;
+	reader.getSparseSetSections(SECTION_MESH_ENTITIES, SECTION_MESHES, meshEntities, meshes);
+	reader.getSparseSetSections(SECTION_MATERIAL_ENTITIES, SECTION_MATERIALS, materialEntities, materials);
+	for (const MeshComponent& mesh : meshes) {
+		if (mesh.VAO >= assets.size())
+			throw std::runtime_error("SceneSnapshot::load: mesh refers to a missing asset");
+	}
+	for (const MaterialComponent& material : materials) {
+		if (material.shader >= assets.size() || material.texture >= assets.size())
+			throw std::runtime_error("SceneSnapshot::load: material refers to a missing asset");
+	}
+
+	// Input components refer to binding profiles by index
+	Span<const size_t> inputEntities;
+	Span<const InputComponent> inputs;
+	Span<const InputBindings> inputBindings = reader.getSection<InputBindings>(SECTION_INPUT_BINDINGS);
+	reader.getSparseSetSections(SECTION_INPUT_ENTITIES, SECTION_INPUTS, inputEntities, inputs);
+	if (inputBindings.size() == 0)
+		throw std::runtime_error("SceneSnapshot::load: snapshot has no input bindings");
+	for (const InputComponent& input : inputs) {
+		if (input.bindings >= inputBindings.size())
+			throw std::runtime_error("SceneSnapshot::load: input refers to missing bindings");
+	}
+
+	// Entities
+	Span<const size_t> componentMasks = reader.getSection<size_t>(SECTION_COMPONENT_MASKS);
+	Span<const size_t> entityGenerations = reader.getSection<size_t>(SECTION_ENTITY_GENERATIONS);
+	Span<const size_t> freeEntityIDs = reader.getSection<size_t>(SECTION_FREE_ENTITY_IDS);
+	if (componentMasks.size() != entityGenerations.size())
+		throw std::runtime_error("SceneSnapshot::load: entity section sizes don't match");
+
+	// Every live entity must own the handle table slot that points back at it
+	Span<const size_t> handleEntities = reader.getSection<size_t>(SECTION_HANDLE_ENTITIES);
+	Span<const size_t> handleGenerations = reader.getSection<size_t>(SECTION_HANDLE_GENERATIONS);
+	Span<const size_t> freeHandles = reader.getSection<size_t>(SECTION_FREE_HANDLES);
+	Span<const size_t> entityHandles = reader.getSection<size_t>(SECTION_ENTITY_HANDLES);
+	if (handleEntities.size() != handleGenerations.size() || entityHandles.size() != componentMasks.size())
+		throw std::runtime_error("SceneSnapshot::load: handle section sizes don't match");
+	for (size_t entityID = 0; entityID < entityGenerations.size(); ++entityID) {
+		if (entityGenerations[entityID] % 2 == 0)
+			continue;
+		size_t handleIndex = entityHandles[entityID];
+		if (handleIndex >= handleEntities.size() || handleEntities[handleIndex] != entityID || handleGenerations[handleIndex] % 2 == 0)
+			throw std::runtime_error("SceneSnapshot::load: handle table doesn't match the live entities");
+	}
+
+	scene.componentMasks.assign(componentMasks.begin(), componentMasks.end());
+	scene.entityGenerations.assign(entityGenerations.begin(), entityGenerations.end());
+	scene.freeEntityIDs.assign(freeEntityIDs.begin(), freeEntityIDs.end());
+	scene.handleEntities.assign(handleEntities.begin(), handleEntities.end());
+	scene.handleGenerations.assign(handleGenerations.begin(), handleGenerations.end());
+	scene.freeHandles.assign(freeHandles.begin(), freeHandles.end());
+	scene.entityHandles.assign(entityHandles.begin(), entityHandles.end());
+
+	// Everything loaded is new to anything tracking changes
+	for (auto& changedFrames : scene.changedFrames)
+		changedFrames.assign(componentMasks.size(), scene.currentFrame);
+
+	// Transforms
+	Span<const size_t> transformEntities = reader.getSection<size_t>(SECTION_TRANSFORM_ENTITIES);
+	Span<const size_t> transformParents = reader.getSection<size_t>(SECTION_TRANSFORM_PARENTS);
+	const SectionID kTRSSections[] = {
+		SECTION_POSITION_X, SECTION_POSITION_Y, SECTION_POSITION_Z,
+		SECTION_ROTATION_X, SECTION_ROTATION_Y, SECTION_ROTATION_Z, SECTION_ROTATION_W,
+		SECTION_SCALE_X, SECTION_SCALE_Y, SECTION_SCALE_Z
+	};
+	const float* trsArrays[10];
+	for (size_t i = 0; i < 10; ++i) {
+		Span<const float> trsArray = reader.getSection<float>(kTRSSections[i]);
+		if (trsArray.size() != transformEntities.size())
+			throw std::runtime_error("SceneSnapshot::load: transform section sizes don't match");
+		trsArrays[i] = trsArray.data();
+	}
+	if (transformParents.size() != transformEntities.size())
+		throw std::runtime_error("SceneSnapshot::load: transform section sizes don't match");
+	TransformMath::TRSArrays trs{
+		trsArrays[0], trsArrays[1], trsArrays[2],
+		trsArrays[3], trsArrays[4], trsArrays[5], trsArrays[6],
+		trsArrays[7], trsArrays[8], trsArrays[9]
+	};
+	scene.transformComponents.assign(transformEntities.data(), transformParents.data(), trs, transformEntities.size());
+
+	// Components
+	loadSparseSet(reader, SECTION_VELOCITY_ENTITIES, SECTION_VELOCITIES, scene.velocityComponents);
+	loadSparseSet(reader, SECTION_ANGULAR_VELOCITY_ENTITIES, SECTION_ANGULAR_VELOCITIES, scene.angualarVelocityComponent);
+	loadSparseSet(reader, SECTION_MOVEMENT_ENTITIES, SECTION_MOVEMENTS, scene.movementComponents);
+	loadSparseSet(reader, SECTION_INPUT_ENTITIES, SECTION_INPUTS, scene.inputComponents);
+	scene.inputBindings.assign(inputBindings.begin(), inputBindings.end());
+	loadSparseSet(reader, SECTION_LOGIC_ENTITIES, SECTION_LOGICS, scene.logicComponents);
+	scene.meshComponents.assign(meshEntities.data(), meshes.data(), meshes.size());
+	scene.materialComponents.assign(materialEntities.data(), materials.data(), materials.size());
+
+	// Swap asset indices for the loaded GPU resources
+	for (MeshComponent& mesh : scene.meshComponents)
+		mesh = assets[mesh.VAO].mesh;
+	for (MaterialComponent& material : scene.materialComponents) {
+		material.shader = assets[material.shader].handle;
+		material.texture = assets[material.texture].handle;
+	}
+
+	// Rebuild the archetype index, views and spin axes from the loaded component masks
+	SceneUtils::rebuildIndices(scene);
+}
+
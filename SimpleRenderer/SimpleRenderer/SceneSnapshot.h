@@ -0,0 +1,47 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Saves and loads scenes as binary snapshots.
+//                A snapshot is a header followed by a table of sections,
+//                each holding one component array exactly as it is laid
+//                out in memory, so loading is a memory mapped bulk copy.
+//                GPU resources are stored as references into a table of
+//                asset names, and are loaded (or reused) when the snapshot
+//                is loaded.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include <string>
+
+struct Scene;
+
+namespace SceneSnapshot {
+	// Increased whenever the layout of a snapshot changes
+	const unsigned kVersion = 4;
+
+	// Writes every entity and component in the scene to a snapshot file.
+	// Throws std::runtime_error if the file can't be written.
+	// Throws std::invalid_argument if a component refers to a GPU resource
+	// that was not loaded from a file, as it couldn't be loaded again.
+	void save(const Scene& scene, const std::string& filename);
+
+	// Replaces every entity and component in the scene with those in a snapshot file.
+	// Entity IDs, generations and the handle table are restored, so handles taken
+	// before the snapshot was saved refer to the same entities once it is loaded,
+	// while handles taken after it was saved fail to resolve.
+	// Every component is marked as changed.
+	// Must be called while no systems are running.
+	// Throws std::runtime_error if the file can't be read, is not a snapshot,
+	// or was saved by a build with different component layouts.
+	// The scene is left unchanged if the file or its assets can't be read,
+	// but may be partially loaded if the snapshot's contents are inconsistent.
+	void load(Scene& scene, const std::string& filename);
+}
@@ -4,10 +4,13 @@
 
 #include "GLUtils.h"
 #include "Scene.h"
+#include "Utils.h"
 
 #include <GLFW\glfw3.h>
 #include <glm\gtc\matrix_transform.hpp>
 
+#include <algorithm>
+#include <functional>
 #include <cmath>
 
 const size_t g_kSphereThetaSegments = 16; // Number of segments from top to bottom of sphere
@@ -17,241 +20,579 @@ const float g_kDThetaSphere = static_cast<float>(M_PI / g_kSphereThetaSegments);
 const float g_kDPhiSphere = static_cast<float>(2 * M_PI / g_kSpherePhiSegments);
 const float g_kDThetaCylinder = static_cast<float>(2 * M_PI / g_kCylinderThetaSegments);
 
-size_t SceneUtils::createEntity(Scene& scene)
-{
-	// Reuse destroyed entityID memory
-	auto freeMem = std::find(scene.componentMasks.begin(), scene.componentMasks.end(), COMPONENT_NONE);
-	if (freeMem != scene.componentMasks.end())
-		return *freeMem;
+namespace {
+	// Adds entities that all have the same new component mask to the views they now match.
+	// The entities must not have been in any view before, so none need removing.
+	void addToViews(Scene& scene, const size_t* entityIDs, size_t count, size_t componentMask)
+	{
+		for (auto& view : scene.views) {
+			size_t viewMask = view.second.getComponentMask();
+			if ((componentMask & viewMask) == viewMask)
+				view.second.add(entityIDs, count);
+		}
+	}
 
-	// Allocate memory for new entityID
-	scene.componentMasks.emplace_back(COMPONENT_NONE);
-	scene.transformComponents.emplace_back();
-	scene.velocityComponents.emplace_back();
-	scene.angualarVelocityComponent.emplace_back();
-	scene.meshComponents.emplace_back();
-	scene.materialComponents.emplace_back();
-	scene.inputComponents.emplace_back();
-	scene.movementComponents.emplace_back();
-	scene.logicComponents.emplace_back();
+	// Enables the same components on many entities that have none yet, one array at a time.
+	// The component data must already have been added.
+	void setNewComponentMasks(Scene& scene, const size_t* entityIDs, size_t count, size_t componentMask)
+	{
+		for (size_t i = 0; i < count; ++i)
+			scene.componentMasks[entityIDs[i]] = componentMask;
+
+		// Newly enabled components need to be picked up by anything tracking changes
+		for (size_t bit = 0; bit < kNumComponentTypes; ++bit) {
+			if (!(componentMask & (static_cast<size_t>(1) << bit)))
+				continue;
+			auto& changedFrames = scene.changedFrames[bit];
+			for (size_t i = 0; i < count; ++i)
+				changedFrames[entityIDs[i]] = scene.currentFrame;
+		}
 
-	return scene.componentMasks.size() - 1;
-}
+		if ((componentMask & kSpinComponents) == kSpinComponents) {
+			for (size_t i = 0; i < count; ++i)
+				scene.transformComponents.setSpinAxis(entityIDs[i], scene.logicComponents[entityIDs[i]].rotationAxis);
+		}
 
-void SceneUtils::destroyEntity(Scene& scene, size_t entityID)
-{
-	scene.componentMasks.at(entityID) = COMPONENT_NONE;
-}
+		scene.archetypes.setComponentMask(entityIDs, count, componentMask);
+		addToViews(scene, entityIDs, count, componentMask);
+	}
 
-size_t SceneUtils::getEntityCount(const Scene& scene)
-{
-	return scene.componentMasks.size();
-}
+	// Gives the entity's transform the spin axis from its logic component if it has
+	// every component in kSpinComponents, otherwise stops the transform spinning
+	void updateSpinAxis(Scene& scene, size_t entityID)
+	{
+		if ((scene.componentMasks[entityID] & kSpinComponents) == kSpinComponents)
+			scene.transformComponents.setSpinAxis(entityID, scene.logicComponents[entityID].rotationAxis);
+		else if (scene.transformComponents.has(entityID))
+			scene.transformComponents.setSpinAxis(entityID, glm::vec3{ 0 });
+	}
 
+	// Brings an allocated entity ID to life with no components.
+	// The caller adds the entity to views, so a batch of entities can be added at once.
+	void initEntity(Scene& scene, size_t entityID)
+	{
+		scene.componentMasks.at(entityID) = COMPONENT_NONE;
+		scene.archetypes.setComponentMask(entityID, COMPONENT_NONE);
+		++scene.entityGenerations.at(entityID); // Mark as alive
+
+		// Give the entity a slot in the handle table
+		size_t handleIndex;
+		if (!scene.freeHandles.empty()) {
+			handleIndex = scene.freeHandles.back();
+			scene.freeHandles.pop_back();
+		}
+		else {
+			handleIndex = scene.handleEntities.size();
+			scene.handleEntities.push_back(0);
+			scene.handleGenerations.push_back(0);
+		}
+		++scene.handleGenerations[handleIndex]; // Mark as alive
+		scene.handleEntities[handleIndex] = entityID;
+		scene.entityHandles.at(entityID) = handleIndex;
+	}
 
-size_t SceneUtils::createQuad(Scene& scene, const glm::mat4& transform)
-{
-	size_t entityID = createEntity(scene);
-	size_t& componentMask = scene.componentMasks.at(entityID);
-	componentMask |= COMPONENT_MESH | COMPONENT_MATERIAL | COMPONENT_TRANSFORM | COMPONENT_LOGIC;
-
-	// Get references to components
-	scene.transformComponents.at(entityID) = transform;
-	MeshComponent& mesh = scene.meshComponents.at(entityID);
-	MaterialComponent& material = scene.materialComponents.at(entityID);
-	InputComponent& input = scene.inputComponents.at(entityID);
-	MovementComponent& movementVars = scene.movementComponents.at(entityID);
-	LogicComponent& logicVars = scene.logicComponents.at(entityID);
-
-	material.shader = GLUtils::getDefaultShader();
-	material.texture = GLUtils::loadTexture("Assets/Textures/random-texture3.png");
-	material.textureType = GL_TEXTURE_2D;
-	material.enableDepth = true;
-	material.shaderParams.metallicness = 1.0f;
-	material.shaderParams.glossiness = 75.0f; // TODO: Fix values getting messed up on the gpu when this is 0 for some reason
-
-	setDefaultInputBindings(input);
+	// Moves a live entity to a free ID, along with all of its components.
+	// Transforms are moved separately, in a batch.
+	void moveEntity(Scene& scene, size_t fromID, size_t toID)
+	{
+		size_t componentMask = scene.componentMasks[fromID];
+
+		// The IDs swap between live and free
+		scene.componentMasks[toID] = componentMask;
+		scene.componentMasks[fromID] = COMPONENT_NONE;
+		++scene.entityGenerations[toID];
+		++scene.entityGenerations[fromID];
+
+		// Handles follow the entity to its new ID
+		size_t handleIndex = scene.entityHandles[fromID];
+		scene.handleEntities[handleIndex] = toID;
+		scene.entityHandles[toID] = handleIndex;
+
+		scene.archetypes.remove(fromID);
+		scene.archetypes.setComponentMask(toID, componentMask);
+		for (auto& view : scene.views) {
+			view.second.remove(fromID);
+			view.second.onComponentMaskChanged(toID, componentMask);
+		}
 
-	movementVars.moveSpeed = 0.1f;
-	movementVars.orientationSensitivity = 0.05f;
-	movementVars.worldSpaceMove = true;
+		// Data for disabled components is kept, so every set is checked, not just the mask
+		scene.velocityComponents.relocate(fromID, toID);
+		scene.angualarVelocityComponent.relocate(fromID, toID);
+		scene.meshComponents.relocate(fromID, toID);
+		scene.materialComponents.relocate(fromID, toID);
+		scene.movementComponents.relocate(fromID, toID);
+		scene.inputComponents.relocate(fromID, toID);
+		scene.logicComponents.relocate(fromID, toID);
+
+		// Anything keyed by entity ID, like the renderer's uniform slots, sees the
+		// entity as new
+		for (auto& changedFrames : scene.changedFrames)
+			changedFrames[toID] = scene.currentFrame;
+	}
+
+	// The components shared by every primitive of a type
+	struct PrimitivePrototype {
+		MeshComponent mesh;
+		MaterialComponent material;
+		glm::vec3 rotationAxis;
+	};
+
+	// Returns the default mesh, material and spin of a primitive type.
+	// Throws std::invalid_argument if the type is not a PrimitiveType.
+	PrimitivePrototype getPrimitivePrototype(SceneUtils::PrimitiveType type)
+	{
+		PrimitivePrototype prototype = {};
+		prototype.material.shader = GLUtils::getDefaultShader();
+		prototype.material.texture = GLUtils::loadTexture(SceneUtils::getPrimitiveTextureFilename(type));
+		prototype.material.textureType = GL_TEXTURE_2D;
+		prototype.material.enableDepth = true;
+		prototype.rotationAxis = glm::vec3{ 0, 1, 0 };
+
+		// TODO: Fix values getting messed up on the gpu when glossiness is 0 for some reason
+		switch (type) {
+		case SceneUtils::PRIMITIVE_QUAD:
+			prototype.mesh = SceneUtils::getQuadMesh();
+			prototype.material.shaderParams.metallicness = 1.0f;
+			prototype.material.shaderParams.glossiness = 75.0f;
+			prototype.rotationAxis = glm::vec3{ 0, 0, 1 };
+			break;
+		case SceneUtils::PRIMITIVE_SPHERE:
+			prototype.mesh = SceneUtils::getSphereMesh();
+			prototype.material.shaderParams.metallicness = 0.3f;
+			prototype.material.shaderParams.glossiness = 2.0f;
+			break;
+		case SceneUtils::PRIMITIVE_CYLINDER:
+			prototype.mesh = SceneUtils::getCylinderMesh();
+			prototype.material.shader = GLUtils::getThresholdShader();
+			prototype.material.shaderParams.metallicness = 0.75f;
+			prototype.material.shaderParams.glossiness = 40.0f;
+			break;
+		case SceneUtils::PRIMITIVE_PYRAMID:
+			prototype.mesh = SceneUtils::getPyramidMesh();
+			prototype.material.shaderParams.metallicness = 0.95f;
+			prototype.material.shaderParams.glossiness = 10.0f;
+			break;
+		case SceneUtils::PRIMITIVE_CUBE:
+			prototype.mesh = SceneUtils::getCubeMesh();
+			prototype.material.shaderParams.metallicness = 0.95f;
+			prototype.material.shaderParams.glossiness = 10.0f;
+			break;
+		default:
+			throw std::invalid_argument("SceneUtils::createPrimitives: unknown primitive type");
+		}
+
+		return prototype;
+	}
 
-	mesh = getQuadMesh();
+	// Shrinks a vector to fit its contents, returning the bytes released
+	template <typename Vector>
+	size_t shrinkToFit(Vector& v)
+	{
+		size_t oldCapacity = v.capacity();
+		v.shrink_to_fit();
+		return (oldCapacity - v.capacity()) * sizeof(typename Vector::value_type);
+	}
+}
+
+size_t SceneUtils::createEntity(Scene& scene)
+{
+	size_t entityID;
+
+	if (!scene.freeEntityIDs.empty()) {
+		// Reuse destroyed entityID memory
+		entityID = scene.freeEntityIDs.back();
+		scene.freeEntityIDs.pop_back();
+	}
+	else {
+		// Allocate memory for new entityID.
+		// Component memory is only allocated when a component is added to the entity.
+		entityID = scene.componentMasks.size();
+		scene.componentMasks.emplace_back(COMPONENT_NONE);
+		scene.entityGenerations.emplace_back(0);
+		scene.entityHandles.emplace_back(0);
+		for (auto& changedFrames : scene.changedFrames)
+			changedFrames.emplace_back(0);
+	}
 
-	logicVars.rotationAxis = glm::vec3{ 0, 0, 1 };
+	initEntity(scene, entityID);
+	addToViews(scene, &entityID, 1, COMPONENT_NONE);
 
 	return entityID;
 }
 
-size_t SceneUtils::createSphere(Scene& scene, const glm::mat4& _transform)
+void SceneUtils::createEntities(Scene& scene, size_t count, std::vector<size_t>& outEntityIDs)
 {
-	size_t entityID = createEntity(scene);
-	size_t& componentMask = scene.componentMasks.at(entityID);
-	componentMask |= COMPONENT_MESH | COMPONENT_MATERIAL | COMPONENT_TRANSFORM | COMPONENT_LOGIC;
+	size_t firstEntity = outEntityIDs.size();
+	reserveMore(outEntityIDs, count);
 
-	// Get references to components
-	glm::mat4& transform = scene.transformComponents.at(entityID);
-	MeshComponent& mesh = scene.meshComponents.at(entityID);
-	MaterialComponent& material = scene.materialComponents.at(entityID);
-	InputComponent& input = scene.inputComponents.at(entityID);
-	MovementComponent& movementVars = scene.movementComponents.at(entityID);
-	LogicComponent& logicVars = scene.logicComponents.at(entityID);
+	// Reuse destroyed entityID memory
+	size_t numReused = std::min(count, scene.freeEntityIDs.size());
+	for (size_t i = 0; i < numReused; ++i) {
+		size_t entityID = scene.freeEntityIDs.back();
+		scene.freeEntityIDs.pop_back();
+		initEntity(scene, entityID);
+		outEntityIDs.push_back(entityID);
+	}
 
-	transform = _transform;
+	// Allocate memory for the rest in one go
+	size_t firstNewID = scene.componentMasks.size();
+	size_t numNew = count - numReused;
+	scene.componentMasks.resize(firstNewID + numNew, COMPONENT_NONE);
+	scene.entityGenerations.resize(firstNewID + numNew, 0);
+	scene.entityHandles.resize(firstNewID + numNew, 0);
+	for (auto& changedFrames : scene.changedFrames)
+		changedFrames.resize(firstNewID + numNew, 0);
+
+	for (size_t entityID = firstNewID; entityID < firstNewID + numNew; ++entityID) {
+		initEntity(scene, entityID);
+		outEntityIDs.push_back(entityID);
+	}
 
-	material.shader = GLUtils::getDefaultShader();
-	material.texture = GLUtils::loadTexture("Assets/Textures/random-texture2.jpg");
-	material.textureType = GL_TEXTURE_2D;
-	material.enableDepth = true;
-	material.shaderParams.metallicness = 0.3f;
-	material.shaderParams.glossiness = 2.0f; // TODO: Fix values getting messed up on the gpu when this is 0 for some reason
+	addToViews(scene, outEntityIDs.data() + firstEntity, count, COMPONENT_NONE);
+}
 
-	mesh = getSphereMesh();
+void SceneUtils::reserveEntities(Scene& scene, size_t count)
+{
+	reserveMore(scene.componentMasks, count);
+	reserveMore(scene.entityGenerations, count);
+	reserveMore(scene.entityHandles, count);
+	for (auto& changedFrames : scene.changedFrames)
+		reserveMore(changedFrames, count);
+	reserveMore(scene.handleEntities, count);
+	reserveMore(scene.handleGenerations, count);
+
+	reserveMore(scene.transformComponents, count);
+	reserveMore(scene.meshComponents, count);
+	reserveMore(scene.materialComponents, count);
+	reserveMore(scene.movementComponents, count);
+	reserveMore(scene.inputComponents, count);
+	reserveMore(scene.logicComponents, count);
+}
 
-	setDefaultInputBindings(input);
+void SceneUtils::destroyEntity(Scene& scene, size_t entityID)
+{
+	if (!isAlive(scene, entityID))
+		return;
 
-	movementVars.moveSpeed = 0.1f;
-	movementVars.orientationSensitivity = 0.05f;
-	movementVars.worldSpaceMove = true;
+	scene.componentMasks.at(entityID) = COMPONENT_NONE;
+	scene.archetypes.remove(entityID);
+	for (auto& view : scene.views)
+		view.second.remove(entityID);
+	++scene.entityGenerations.at(entityID);
+	scene.freeEntityIDs.push_back(entityID);
+
+	// Free the handle table slot, invalidating existing handles
+	size_t handleIndex = scene.entityHandles[entityID];
+	++scene.handleGenerations[handleIndex];
+	scene.freeHandles.push_back(handleIndex);
+
+	// Release component memory
+	scene.transformComponents.remove(entityID);
+	scene.velocityComponents.remove(entityID);
+	scene.angualarVelocityComponent.remove(entityID);
+	scene.meshComponents.remove(entityID);
+	scene.materialComponents.remove(entityID);
+	scene.movementComponents.remove(entityID);
+	scene.inputComponents.remove(entityID);
+	scene.logicComponents.remove(entityID);
+}
 
-	logicVars.rotationAxis = glm::vec3{ 0, 1, 0 };
+size_t SceneUtils::getEntityCount(const Scene& scene)
+{
+	return scene.componentMasks.size();
+}
 
-	return entityID;
+void SceneUtils::setComponentMask(Scene& scene, size_t entityID, size_t componentMask)
+{
+	// Make sure enabled components have data
+	if (componentMask & COMPONENT_TRANSFORM)
+		scene.transformComponents.emplace(entityID);
+	if (componentMask & COMPONENT_VELOCITY)
+		scene.velocityComponents.emplace(entityID);
+	if (componentMask & COMPONENT_ANGULAR_VELOCITY)
+		scene.angualarVelocityComponent.emplace(entityID);
+	if (componentMask & COMPONENT_MESH)
+		scene.meshComponents.emplace(entityID);
+	if (componentMask & COMPONENT_MATERIAL)
+		scene.materialComponents.emplace(entityID);
+	if (componentMask & COMPONENT_MOVEMENT)
+		scene.movementComponents.emplace(entityID);
+	if (componentMask & COMPONENT_INPUT)
+		scene.inputComponents.emplace(entityID);
+	if (componentMask & COMPONENT_LOGIC)
+		scene.logicComponents.emplace(entityID);
+
+	// Newly enabled components need to be picked up by anything tracking changes
+	size_t oldComponentMask = scene.componentMasks.at(entityID);
+	markChanged(scene, entityID, componentMask & ~oldComponentMask);
+
+	scene.componentMasks.at(entityID) = componentMask;
+	if ((oldComponentMask & kSpinComponents) != (componentMask & kSpinComponents))
+		updateSpinAxis(scene, entityID);
+	scene.archetypes.setComponentMask(entityID, componentMask);
+	for (auto& view : scene.views)
+		view.second.onComponentMaskChanged(entityID, componentMask);
 }
 
-size_t SceneUtils::createCylinder(Scene& scene, float radius, float height, const glm::mat4& _transform)
+void SceneUtils::addComponents(Scene& scene, size_t entityID, size_t components)
 {
-	size_t entityID = createEntity(scene);
-	size_t& componentMask = scene.componentMasks.at(entityID);
-	componentMask |= COMPONENT_MESH | COMPONENT_MATERIAL | COMPONENT_TRANSFORM | COMPONENT_LOGIC;
+	setComponentMask(scene, entityID, scene.componentMasks.at(entityID) | components);
+}
+
+void SceneUtils::removeComponents(Scene& scene, size_t entityID, size_t components)
+{
+	setComponentMask(scene, entityID, scene.componentMasks.at(entityID) & ~components);
+}
 
-	// Get references to components
-	glm::mat4& transform = scene.transformComponents.at(entityID);
-	MeshComponent& mesh = scene.meshComponents.at(entityID);
-	MaterialComponent& material = scene.materialComponents.at(entityID);
-	InputComponent& input = scene.inputComponents.at(entityID);
-	MovementComponent& movementVars = scene.movementComponents.at(entityID);
-	LogicComponent& logicVars = scene.logicComponents.at(entityID);
+void SceneUtils::setRotationAxis(Scene& scene, size_t entityID, const glm::vec3& axis)
+{
+	scene.logicComponents.at(entityID).rotationAxis = axis;
+	updateSpinAxis(scene, entityID);
+}
 
-	transform = _transform * glm::scale(glm::mat4{ 1 }, glm::vec3{ radius, height, radius });
+void SceneUtils::advanceFrame(Scene& scene)
+{
+	++scene.currentFrame;
+}
 
-	material.shader = GLUtils::getThresholdShader();
-	material.texture = GLUtils::loadTexture("Assets/Textures/random-texture4.jpg");
-	material.textureType = GL_TEXTURE_2D;
-	material.enableDepth = true;
-	material.shaderParams.metallicness = 0.75f;
-	material.shaderParams.glossiness = 40.0f; // TODO: Fix values getting messed up on the gpu when this is 0 for some reason
+void SceneUtils::markChanged(Scene& scene, size_t entityID, size_t components)
+{
+	for (size_t i = 0; i < kNumComponentTypes; ++i) {
+		if (components & (static_cast<size_t>(1) << i))
+			scene.changedFrames[i].at(entityID) = scene.currentFrame;
+	}
+}
 
-	mesh = getCylinderMesh();
+uint32_t SceneUtils::getChangedFrame(const Scene& scene, size_t entityID, size_t component)
+{
+	for (size_t i = 0; i < kNumComponentTypes; ++i) {
+		if (component == (static_cast<size_t>(1) << i))
+			return scene.changedFrames[i].at(entityID);
+	}
+	return 0;
+}
 
-	setDefaultInputBindings(input);
+bool SceneUtils::isAlive(const Scene& scene, size_t entityID)
+{
+	return entityID < scene.entityGenerations.size() 
+	    && scene.entityGenerations[entityID] % 2 == 1;
+}
 
-	movementVars.moveSpeed = 0.1f;
-	movementVars.orientationSensitivity = 0.05f;
-	movementVars.worldSpaceMove = true;
+EntityHandle SceneUtils::getHandle(const Scene& scene, size_t entityID)
+{
+	if (!isAlive(scene, entityID))
+		return EntityHandle{};
 
-	logicVars.rotationAxis = glm::vec3{ 0, 1, 0 };
+	size_t handleIndex = scene.entityHandles[entityID];
+	return EntityHandle{ handleIndex, scene.handleGenerations[handleIndex] };
+}
 
-	return entityID;
+bool SceneUtils::resolveHandle(const Scene& scene, const EntityHandle& handle, size_t& outEntityID)
+{
+	// Live slots have odd generations, so a default constructed handle never matches
+	if (handle.index >= scene.handleGenerations.size() 
+	 || scene.handleGenerations[handle.index] != handle.generation
+	 || handle.generation % 2 == 0)
+		return false;
+
+	outEntityID = scene.handleEntities[handle.index];
+	return true;
 }
 
-size_t SceneUtils::createPyramid(Scene& scene, const glm::mat4& _transform)
+SceneUtils::CompactionResult SceneUtils::compactEntities(Scene& scene, size_t maxMoves)
 {
-	size_t entityID = createEntity(scene);
-	size_t& componentMask = scene.componentMasks.at(entityID);
-	componentMask |= COMPONENT_MESH | COMPONENT_MATERIAL | COMPONENT_TRANSFORM | COMPONENT_LOGIC;
+	CompactionResult result{ 0, 0, false };
 
-	// Get references to components
-	glm::mat4& transform = scene.transformComponents.at(entityID);
-	MeshComponent& mesh = scene.meshComponents.at(entityID);
-	MaterialComponent& material = scene.materialComponents.at(entityID);
-	InputComponent& input = scene.inputComponents.at(entityID);
-	MovementComponent& movementVars = scene.movementComponents.at(entityID);
-	LogicComponent& logicVars = scene.logicComponents.at(entityID);
+	// Fill the lowest free IDs first, taking them from the back
+	std::vector<size_t>& freeIDs = scene.freeEntityIDs;
+	std::sort(freeIDs.begin(), freeIDs.end(), std::greater<size_t>());
 
-	transform = _transform;
+	// Free IDs at the end of the range are dropped rather than filled
+	size_t entityCount = scene.componentMasks.size();
+	auto dropDeadEntities = [&scene, &entityCount]() {
+		while (entityCount > 0 && !isAlive(scene, entityCount - 1))
+			--entityCount;
+	};
+	dropDeadEntities();
+
+	// Move the entities with the highest IDs into the lowest free IDs
+	std::vector<size_t> fromIDs;
+	std::vector<size_t> toIDs;
+	while (result.numMoved < maxMoves && !freeIDs.empty() && freeIDs.back() < entityCount) {
+		size_t toID = freeIDs.back();
+		freeIDs.pop_back();
+		size_t fromID = entityCount - 1;
+		moveEntity(scene, fromID, toID);
+		fromIDs.push_back(fromID);
+		toIDs.push_back(toID);
+		++result.numMoved;
+
+		dropDeadEntities();
+	}
+	scene.transformComponents.relocate(fromIDs.data(), toIDs.data(), fromIDs.size());
+
+	// Forget the dropped IDs, they are recreated at the end of the range when needed
+	freeIDs.erase(std::remove_if(freeIDs.begin(), freeIDs.end(), [entityCount](size_t entityID) {
+		return entityID >= entityCount;
+	}), freeIDs.end());
+	scene.componentMasks.resize(entityCount);
+	scene.entityGenerations.resize(entityCount);
+	scene.entityHandles.resize(entityCount);
+	for (auto& changedFrames : scene.changedFrames)
+		changedFrames.resize(entityCount);
+
+	result.isComplete = freeIDs.empty();
+	if (!result.isComplete)
+		return result;
+
+	// The live entities are dense, so release the memory that held the holes.
+	// Shrinking is left until the end so it only reallocates once.
+	result.bytesReclaimed += shrinkToFit(scene.componentMasks);
+	result.bytesReclaimed += shrinkToFit(scene.entityGenerations);
+	result.bytesReclaimed += shrinkToFit(scene.entityHandles);
+	result.bytesReclaimed += shrinkToFit(scene.freeEntityIDs);
+	for (auto& changedFrames : scene.changedFrames)
+		result.bytesReclaimed += shrinkToFit(changedFrames);
+	result.bytesReclaimed += scene.transformComponents.shrinkToFit(entityCount);
+	result.bytesReclaimed += scene.velocityComponents.shrinkToFit(entityCount);
+	result.bytesReclaimed += scene.angualarVelocityComponent.shrinkToFit(entityCount);
+	result.bytesReclaimed += scene.meshComponents.shrinkToFit(entityCount);
+	result.bytesReclaimed += scene.materialComponents.shrinkToFit(entityCount);
+	result.bytesReclaimed += scene.movementComponents.shrinkToFit(entityCount);
+	result.bytesReclaimed += scene.inputComponents.shrinkToFit(entityCount);
+	result.bytesReclaimed += scene.logicComponents.shrinkToFit(entityCount);
+
+	// Views and archetypes are rebuilt rather than shrunk, dropping empty chunks too
+	rebuildIndices(scene);
+
+	return result;
+}
 
-	material.shader = GLUtils::getDefaultShader();
-	material.texture = GLUtils::loadTexture("Assets/Textures/random-texture.jpg");
-	material.textureType = GL_TEXTURE_2D;
-	material.enableDepth = true;
-	material.shaderParams.metallicness = 0.95f;
-	material.shaderParams.glossiness = 10.0f; // TODO: Fix values getting messed up on the gpu when this is 0 for some reason
+void SceneUtils::rebuildIndices(Scene& scene)
+{
+	// Views are reset in place, so references to them stay valid
+	scene.archetypes = ArchetypeIndex{};
+	for (auto& view : scene.views)
+		view.second = EntityView{ view.second.getComponentMask() };
+	for (size_t entityID = 0; entityID < scene.componentMasks.size(); ++entityID) {
+		if (!isAlive(scene, entityID))
+			continue;
+		scene.archetypes.setComponentMask(entityID, scene.componentMasks[entityID]);
+		for (auto& view : scene.views)
+			view.second.onComponentMaskChanged(entityID, scene.componentMasks[entityID]);
+		updateSpinAxis(scene, entityID);
+	}
+}
 
-	mesh = getPyramidMesh();
 
-	setDefaultInputBindings(input);
+size_t SceneUtils::createQuad(Scene& scene, const glm::mat4& transform)
+{
+	return createPrimitive(scene, PRIMITIVE_QUAD, transform);
+}
 
-	movementVars.moveSpeed = 0.1f;
-	movementVars.orientationSensitivity = 0.05f;
-	movementVars.worldSpaceMove = true;
+size_t SceneUtils::createSphere(Scene& scene, const glm::mat4& _transform)
+{
+	return createPrimitive(scene, PRIMITIVE_SPHERE, _transform);
+}
 
-	logicVars.rotationAxis = glm::vec3{ 0, 1, 0 };
+size_t SceneUtils::createCylinder(Scene& scene, float radius, float height, const glm::mat4& _transform)
+{
+	return createPrimitive(scene, PRIMITIVE_CYLINDER, _transform * glm::scale(glm::mat4{ 1 }, glm::vec3{ radius, height, radius }));
+}
 
-	return entityID;
+size_t SceneUtils::createPyramid(Scene& scene, const glm::mat4& _transform)
+{
+	return createPrimitive(scene, PRIMITIVE_PYRAMID, _transform);
 }
 
 size_t SceneUtils::createCube(Scene& scene, const glm::mat4 & _transform)
 {
-	size_t entityID = createEntity(scene);
-	size_t& componentMask = scene.componentMasks.at(entityID);
-	componentMask |= COMPONENT_MESH | COMPONENT_MATERIAL | COMPONENT_TRANSFORM | COMPONENT_LOGIC;
-
-	// Get references to components
-	glm::mat4& transform = scene.transformComponents.at(entityID);
-	MeshComponent& mesh = scene.meshComponents.at(entityID);
-	MaterialComponent& material = scene.materialComponents.at(entityID);
-	InputComponent& input = scene.inputComponents.at(entityID);
-	MovementComponent& movementVars = scene.movementComponents.at(entityID);
-	LogicComponent& logicVars = scene.logicComponents.at(entityID);
-
-	transform = _transform;
-
-	material.shader = GLUtils::getDefaultShader();
-	material.texture = GLUtils::loadTexture("Assets/Textures/random-texture3.png");
-	material.textureType = GL_TEXTURE_2D;
-	material.enableDepth = true;
-	material.shaderParams.metallicness = 0.95f;
-	material.shaderParams.glossiness = 10.0f; // TODO: Fix values getting messed up on the gpu when this is 0 for some reason
+	return createPrimitive(scene, PRIMITIVE_CUBE, _transform);
+}
 
-	mesh = getCubeMesh();
+const char* SceneUtils::getPrimitiveTextureFilename(PrimitiveType type)
+{
+	switch (type) {
+	case PRIMITIVE_QUAD:
+	case PRIMITIVE_CUBE:
+		return "Assets/Textures/random-texture3.png";
+	case PRIMITIVE_SPHERE:
+		return "Assets/Textures/random-texture2.jpg";
+	case PRIMITIVE_CYLINDER:
+		return "Assets/Textures/random-texture4.jpg";
+	case PRIMITIVE_PYRAMID:
+		return "Assets/Textures/random-texture.jpg";
+	default:
+		throw std::invalid_argument("SceneUtils::getPrimitiveTextureFilename: unknown primitive type");
+	}
+}
 
-	setDefaultInputBindings(input);
+size_t SceneUtils::createPrimitive(Scene& scene, PrimitiveType type, const glm::mat4& transform)
+{
+	std::vector<size_t> entityIDs;
+	createPrimitives(scene, type, &transform, 1, entityIDs);
+	return entityIDs.front();
+}
 
+void SceneUtils::createPrimitives(Scene& scene, PrimitiveType type, const glm::mat4* transforms, size_t count, std::vector<size_t>& outEntityIDs, const MaterialComponent* materialOverrides)
+{
+	// Resolve the resources shared by every instance up front
+	PrimitivePrototype prototype = getPrimitivePrototype(type);
+	InputComponent input;
+	setDefaultInputBindings(scene, input);
+	MovementComponent movementVars;
 	movementVars.moveSpeed = 0.1f;
 	movementVars.orientationSensitivity = 0.05f;
 	movementVars.worldSpaceMove = true;
-
-	logicVars.rotationAxis = glm::vec3{ 0, 1, 0 };
-
-	return entityID;
+	LogicComponent logic = {};
+	logic.rotationAxis = prototype.rotationAxis;
+
+	reserveEntities(scene, count);
+	size_t firstEntity = outEntityIDs.size();
+	createEntities(scene, count, outEntityIDs);
+	const size_t* entityIDs = outEntityIDs.data() + firstEntity;
+
+	// Fill one component type at a time, so each batch only touches one array.
+	// Input and movement are filled in but not enabled, they are enabled when the primitive is possessed.
+	scene.transformComponents.emplace(entityIDs, transforms, count);
+	scene.meshComponents.insert(entityIDs, count, prototype.mesh);
+	if (materialOverrides)
+		scene.materialComponents.insert(entityIDs, materialOverrides, count);
+	else
+		scene.materialComponents.insert(entityIDs, count, prototype.material);
+	scene.logicComponents.insert(entityIDs, count, logic);
+	scene.inputComponents.insert(entityIDs, count, input);
+	scene.movementComponents.insert(entityIDs, count, movementVars);
+
+	// The new entities have no components yet, so the whole batch joins the same views
+	setNewComponentMasks(scene, entityIDs, count, COMPONENT_MESH | COMPONENT_MATERIAL | COMPONENT_TRANSFORM | COMPONENT_LOGIC);
 }
 
 size_t SceneUtils::createCamera(Scene& scene, const glm::vec3& pos, const glm::vec3& center, const glm::vec3& up)
 {
 	size_t entityID = createEntity(scene);
 
-	size_t& componentMask = scene.componentMasks.at(entityID);
-	componentMask = COMPONENT_CAMERA | COMPONENT_INPUT | COMPONENT_MOVEMENT | COMPONENT_TRANSFORM;
+	setComponentMask(scene, entityID, COMPONENT_CAMERA | COMPONENT_INPUT | COMPONENT_MOVEMENT | COMPONENT_TRANSFORM);
 
-	InputComponent& input = scene.inputComponents.at(entityID);
-	MovementComponent& movementVars = scene.movementComponents.at(entityID);
-	glm::mat4& transform = scene.transformComponents.at(entityID);
+	InputComponent& input = scene.inputComponents.emplace(entityID);
+	MovementComponent& movementVars = scene.movementComponents.emplace(entityID);
 
+	InputBindings bindings = {};
+	bindings.mouseInputEnabled = true;
+	bindings.leftBtnMap = GLFW_KEY_A;
+	bindings.rightBtnMap = GLFW_KEY_D;
+	bindings.forwardBtnMap = GLFW_KEY_W;
+	bindings.backwardBtnMap = GLFW_KEY_S;
+	bindings.downBtnMap = GLFW_KEY_Q;
+	bindings.upBtnMap = GLFW_KEY_E;
 	input = {};
-	input.mouseInputEnabled = true;
-	input.leftBtnMap = GLFW_KEY_A;
-	input.rightBtnMap = GLFW_KEY_D;
-	input.forwardBtnMap = GLFW_KEY_W;
-	input.backwardBtnMap = GLFW_KEY_S;
-	input.downBtnMap = GLFW_KEY_Q;
-	input.upBtnMap = GLFW_KEY_E;
+	input.bindings = addInputBindings(scene, bindings);
 
 	movementVars.moveSpeed = 0.1f;
 	movementVars.orientationSensitivity = 0.005f;
 	movementVars.worldSpaceMove = false;
 
-	transform = glm::inverse(glm::lookAt(pos, center, up));
+	scene.transformComponents.setLocal(entityID, glm::inverse(glm::lookAt(pos, center, up)));
 
 	return entityID;
 }
@@ -260,13 +601,10 @@ size_t SceneUtils::createSkybox(Scene& scene, const std::vector<std::string>& fa
 {
 	size_t entityID = createEntity(scene);
 
-	size_t& componentMask = scene.componentMasks.at(entityID);
-	componentMask = COMPONENT_MATERIAL | COMPONENT_MESH;
+	setComponentMask(scene, entityID, COMPONENT_MATERIAL | COMPONENT_MESH);
 
-	MaterialComponent& material = scene.materialComponents.at(entityID);
-	InputComponent& input = scene.inputComponents.at(entityID);
-	MovementComponent& movementVars = scene.movementComponents.at(entityID);
-	MeshComponent& mesh = scene.meshComponents.at(entityID);
+	MaterialComponent& material = scene.materialComponents.emplace(entityID);
+	MeshComponent& mesh = scene.meshComponents.emplace(entityID);
 
 	material = {};
 	material.shader = GLUtils::getSkyboxShader();
@@ -279,24 +617,57 @@ size_t SceneUtils::createSkybox(Scene& scene, const std::vector<std::string>& fa
 	return entityID;
 }
 
-void SceneUtils::setDefaultInputBindings(InputComponent& input)
+uint32_t SceneUtils::addInputBindings(Scene& scene, const InputBindings& bindings)
 {
+	auto isSame = [&bindings](const InputBindings& other) {
+		return bindings.leftBtnMap == other.leftBtnMap
+			&& bindings.rightBtnMap == other.rightBtnMap
+			&& bindings.forwardBtnMap == other.forwardBtnMap
+			&& bindings.backwardBtnMap == other.backwardBtnMap
+			&& bindings.upBtnMap == other.upBtnMap
+			&& bindings.downBtnMap == other.downBtnMap
+			&& bindings.azimuthPosBtnMap == other.azimuthPosBtnMap
+			&& bindings.azimuthNegBtnMap == other.azimuthNegBtnMap
+			&& bindings.elevationPosBtnMap == other.elevationPosBtnMap
+			&& bindings.elevationNegBtnMap == other.elevationNegBtnMap
+			&& bindings.rollBtnMap == other.rollBtnMap
+			&& bindings.mouseInputEnabled == other.mouseInputEnabled
+			&& bindings.btn1Map == other.btn1Map
+			&& bindings.btn2Map == other.btn2Map
+			&& bindings.btn3Map == other.btn3Map
+			&& bindings.btn4Map == other.btn4Map;
+	};
+
+	// There are only ever a handful of profiles, so a linear search is fine
+	auto it = std::find_if(scene.inputBindings.begin(), scene.inputBindings.end(), isSame);
+	if (it != scene.inputBindings.end())
+		return static_cast<uint32_t>(it - scene.inputBindings.begin());
+
+	scene.inputBindings.push_back(bindings);
+	return static_cast<uint32_t>(scene.inputBindings.size() - 1);
+}
+
+void SceneUtils::setDefaultInputBindings(Scene& scene, InputComponent& input)
+{
+	InputBindings bindings = {};
+	bindings.leftBtnMap = GLFW_KEY_KP_4;
+	bindings.rightBtnMap = GLFW_KEY_KP_6;
+	bindings.forwardBtnMap = GLFW_KEY_KP_8;
+	bindings.backwardBtnMap = GLFW_KEY_KP_5;
+	bindings.downBtnMap = GLFW_KEY_KP_7;
+	bindings.upBtnMap = GLFW_KEY_KP_9;
+	bindings.azimuthPosBtnMap = GLFW_KEY_KP_1;
+	bindings.azimuthNegBtnMap = GLFW_KEY_KP_2;
+	bindings.elevationPosBtnMap = GLFW_KEY_KP_3;
+	bindings.elevationNegBtnMap = GLFW_KEY_KP_DECIMAL;
+	bindings.rollBtnMap = GLFW_KEY_KP_0;
+	bindings.btn1Map = GLFW_KEY_KP_ADD;
+	bindings.btn2Map = GLFW_KEY_KP_SUBTRACT;
+	bindings.btn3Map = GLFW_KEY_KP_MULTIPLY;
+	bindings.btn4Map = GLFW_KEY_KP_DIVIDE;
+
 	input = {};
-	input.leftBtnMap = GLFW_KEY_KP_4;
-	input.rightBtnMap = GLFW_KEY_KP_6;
-	input.forwardBtnMap = GLFW_KEY_KP_8;
-	input.backwardBtnMap = GLFW_KEY_KP_5;
-	input.downBtnMap = GLFW_KEY_KP_7;
-	input.upBtnMap = GLFW_KEY_KP_9;
-	input.azimuthPosBtnMap = GLFW_KEY_KP_1;
-	input.azimuthNegBtnMap = GLFW_KEY_KP_2;
-	input.elevationPosBtnMap = GLFW_KEY_KP_3;
-	input.elevationNegBtnMap = GLFW_KEY_KP_DECIMAL;
-	input.rollBtnMap = GLFW_KEY_KP_0;
-	input.btn1Map = GLFW_KEY_KP_ADD;
-	input.btn2Map = GLFW_KEY_KP_SUBTRACT;
-	input.btn3Map = GLFW_KEY_KP_MULTIPLY;
-	input.btn4Map = GLFW_KEY_KP_DIVIDE;
+	input.bindings = addInputBindings(scene, bindings);
 }
 
 const std::vector<VertexFormat>& SceneUtils::getSphereVertices()
@@ -577,12 +948,7 @@ MeshComponent SceneUtils::getQuadMesh()
 {
 	static const std::vector<VertexFormat>& vertices = getQuadVertices();
 	static const std::vector<GLuint>& indices = getQuadIndices();
-	static const MeshComponent mesh{
-		GLUtils::bufferVertices(vertices, indices),
-		static_cast<GLsizei>(indices.size()),
-		&vertices,
-		&indices
-	};
+	static const MeshComponent mesh = GLUtils::bufferVertices(vertices, indices);
 
 	return mesh;
 }
@@ -591,12 +957,7 @@ MeshComponent SceneUtils::getSphereMesh()
 {
 	static const std::vector<VertexFormat>& vertices = getSphereVertices();
 	static const std::vector<GLuint>& indices = getSphereIndices();
-	static const MeshComponent mesh{
-		GLUtils::bufferVertices(vertices, indices),
-		static_cast<GLsizei>(indices.size()),
-		&vertices,
-		&indices
-	};
+	static const MeshComponent mesh = GLUtils::bufferVertices(vertices, indices);
 
 	return mesh;
 }
@@ -605,12 +966,7 @@ MeshComponent SceneUtils::getCylinderMesh()
 {
 	static const std::vector<VertexFormat>& vertices = getCylinderVertices();
 	static const std::vector<GLuint>& indices = getCylinderIndices();
-	static const MeshComponent mesh{
-		GLUtils::bufferVertices(vertices, indices),
-		static_cast<GLsizei>(indices.size()),
-		&vertices,
-		&indices
-	};
+	static const MeshComponent mesh = GLUtils::bufferVertices(vertices, indices);
 
 	return mesh;
 }
@@ -619,12 +975,7 @@ MeshComponent SceneUtils::getPyramidMesh()
 {
 	static const std::vector<VertexFormat>& vertices = getPyramidVertices();
 	static const std::vector<GLuint>& indices = getPyramidIndices();
-	static const MeshComponent mesh{
-		GLUtils::bufferVertices(vertices, indices),
-		static_cast<GLsizei>(indices.size()),
-		&vertices,
-		&indices
-	};
+	static const MeshComponent mesh = GLUtils::bufferVertices(vertices, indices);
 
 	return mesh;
 }
@@ -633,12 +984,7 @@ MeshComponent SceneUtils::getCubeMesh()
 {
 	static const std::vector<VertexFormat>& vertices = getCubeVertices();
 	static const std::vector<GLuint>& indices = getCubeIndices();
-	static const MeshComponent mesh{
-		GLUtils::bufferVertices(vertices, indices),
-		static_cast<GLsizei>(indices.size()),
-		&vertices,
-		&indices
-	};
+	static const MeshComponent mesh = GLUtils::bufferVertices(vertices, indices);
 
 	return mesh;
 }
@@ -16,23 +16,125 @@
 #include <glad\glad.h>
 #include <glm\glm.hpp>
 
+#include <cstdint>
 #include <vector>
 
 struct Scene;
+struct EntityHandle;
 struct VertexFormat;
 struct MeshComponent;
+struct MaterialComponent;
+struct InputBindings;
 struct InputComponent;
 
 namespace SceneUtils {
-	// Creates a new entity in the scene and returns its ID
+	// Creates a new entity in the scene and returns its ID.
+	// IDs of destroyed entities are reused in O(1) time.
 	size_t createEntity(Scene& scene);
 
-	// Destroys an entity in the scene
+	// Creates count new entities in the scene and appends their IDs to outEntityIDs.
+	// Destroyed IDs are reused first, then the scene's per entity arrays are
+	// grown once for all of the remaining entities.
+	void createEntities(Scene& scene, size_t count, std::vector<size_t>& outEntityIDs);
+
+	// Reserves memory for count more entities, so that creating them one at a
+	// time with the create functions below doesn't reallocate.
+	// Space is reserved for every component used by the create functions.
+	// Capacity still grows geometrically, so reserving for many small batches stays cheap.
+	void reserveEntities(Scene& scene, size_t count);
+
+	// Destroys an entity in the scene.
+	// Does nothing if the entity has already been destroyed.
 	void destroyEntity(Scene& scene, size_t entityID);
 
-	// Returns the number of entities in the scene
+	// Returns the number of entity IDs in use by the scene.
+	// This includes the IDs of destroyed entities that have not been reused yet.
 	size_t getEntityCount(const Scene& scene);
 
+	// Sets which components are enabled on the entity.
+	// Components that are enabled but have no data yet are value initialized.
+	void setComponentMask(Scene& scene, size_t entityID, size_t componentMask);
+
+	// Enables the specified components on the entity
+	void addComponents(Scene& scene, size_t entityID, size_t components);
+
+	// Disables the specified components on the entity.
+	// The component data is kept so that the components can be enabled again later.
+	void removeComponents(Scene& scene, size_t entityID, size_t components);
+
+	// Sets the axis the entity spins about, which is kept in its LogicComponent.
+	// Throws std::out_of_range if the entity has no logic component.
+	void setRotationAxis(Scene& scene, size_t entityID, const glm::vec3& axis);
+
+	// Starts a new frame.
+	// Changes made from here on are seen as newer than anything consumed last frame.
+	void advanceFrame(Scene& scene);
+
+	// Records that the specified components of the entity have changed this frame.
+	// Must be called by anything that writes component data that is uploaded to the GPU.
+	// Safe to call from multiple threads for different entities, or for different components.
+	void markChanged(Scene& scene, size_t entityID, size_t components);
+
+	// Returns the frame the component last changed on.
+	// component must be a single ComponentMask bit.
+	uint32_t getChangedFrame(const Scene& scene, size_t entityID, size_t component);
+
+	// Returns true if the entity ID refers to a live entity
+	bool isAlive(const Scene& scene, size_t entityID);
+
+	// Returns a handle to a live entity.
+	// The handle can be held onto and resolved later to check that the 
+	// entity has not been destroyed in the mean time.
+	EntityHandle getHandle(const Scene& scene, size_t entityID);
+
+	// Gets the ID of the entity referred to by the handle.
+	// Returns false if the entity has been destroyed.
+	bool resolveHandle(const Scene& scene, const EntityHandle& handle, size_t& outEntityID);
+
+	// The result of a call to compactEntities
+	struct CompactionResult {
+		size_t numMoved;       // Live entities given lower IDs
+		size_t bytesReclaimed; // Capacity released by the scene's arrays and component storage
+		bool isComplete;       // True once the live entities fill a dense range of IDs
+	};
+
+	// Moves up to maxMoves live entities from the end of the ID range into the
+	// IDs of destroyed entities, so the scene's arrays can shrink.
+	// Call once per frame until the result is complete to spread the work out.
+	// Once complete, the per entity arrays and component storage are shrunk to fit.
+	// Handles still refer to the same entities, but entity IDs held anywhere
+	// else are invalidated. Must not be called while systems are running.
+	CompactionResult compactEntities(Scene& scene, size_t maxMoves);
+
+	// Rebuilds the archetype index, views and transform spin axes from the component masks.
+	// Views are updated in place, so references to them stay valid.
+	void rebuildIndices(Scene& scene);
+
+	// The shapes that can be created with createPrimitives
+	enum PrimitiveType {
+		PRIMITIVE_QUAD,
+		PRIMITIVE_SPHERE,
+		PRIMITIVE_CYLINDER,
+		PRIMITIVE_PYRAMID,
+		PRIMITIVE_CUBE
+	};
+
+	// Returns the file the default material of a primitive type loads its texture from.
+	// Throws std::invalid_argument if the type is unknown.
+	const char* getPrimitiveTextureFilename(PrimitiveType type);
+
+	// Creates a primitive of the specified type with its default material.
+	// The cylinder has a radius and height of 1.
+	size_t createPrimitive(Scene&, PrimitiveType type, const glm::mat4& transform = glm::mat4{ 1 });
+
+	// Creates count primitives of the same type, one for each transform, and
+	// appends their IDs to outEntityIDs.
+	// If materialOverrides is not null, materialOverrides[i] is used in place of
+	// the default material for the i'th primitive.
+	// Storage is reserved and shared resources are looked up once for the whole batch.
+	// Throws std::invalid_argument if the type is unknown.
+	void createPrimitives(Scene&, PrimitiveType type, const glm::mat4* transforms, size_t count, std::vector<size_t>& outEntityIDs, const MaterialComponent* materialOverrides = nullptr);
+
 	// Creates a unit square facing down the positive z axis with the 
 	// specified transform
 	size_t createQuad(Scene&, const glm::mat4& transform = glm::mat4{ 1 });
@@ -58,8 +160,14 @@ namespace SceneUtils {
 	// Can be used to set the environment map for the renderer.
 	size_t createSkybox(Scene&, const std::vector<std::string>& faceFilenames);
 	
-	// Handles boilerplate input binding
-	void setDefaultInputBindings(InputComponent& input);
+	// Adds a binding profile for input components to share.
+	// Returns the index to store in InputComponent::bindings.
+	// If an identical profile has already been added its index is returned instead.
+	uint32_t addInputBindings(Scene&, const InputBindings& bindings);
+
+	// Handles boilerplate input binding.
+	// Resets the input and binds it to the shared numpad profile.
+	void setDefaultInputBindings(Scene&, InputComponent& input);
 
 	// Returns the vertices to construct a quad.
 	// This function is cached for efficiency 
@@ -111,27 +219,27 @@ namespace SceneUtils {
 	// (only 1 set of indices will be constructed).
 	const std::vector<GLuint>& getCubeIndices();
 
-	// Returns a Mesh Component containing the VAO for a quad.
+	// Returns a Mesh Component for a quad.
 	// This function is cached for efficiency 
 	// (Only 1 mesh will be buffered).
 	MeshComponent getQuadMesh();
 
-	// Returns a Mesh Component containing the VAO for a sphere.
+	// Returns a Mesh Component for a sphere.
 	// This function is cached for efficiency 
 	// (Only 1 mesh will be buffered).
 	MeshComponent getSphereMesh();
 
-	// Returns a Mesh Component containing the VAO for a cylinder.
+	// Returns a Mesh Component for a cylinder.
 	// This function is cached for efficiency 
 	// (Only 1 mesh will be buffered).
 	MeshComponent getCylinderMesh();
 
-	// Returns a Mesh Component containing the VAO for a pyramid.
+	// Returns a Mesh Component for a pyramid.
 	// This function is cached for efficiency
 	// (Only 1 mesh will be buffered).
 	MeshComponent getPyramidMesh();
 
-	// Returns a Mesh Component containing the VAO for a cube.
+	// Returns a Mesh Component for a cube.
 	// This function is cached for efficiency
 	// (Only 1 mesh will be buffered).
 	MeshComponent getCubeMesh();
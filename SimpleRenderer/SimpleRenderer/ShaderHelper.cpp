@@ -21,6 +21,7 @@ GLuint compileFragmentShader(const char* shaderCode);
 GLuint compileShader(GLenum ShaderType, const char* shaderCode);
 GLuint linkProgram(GLuint vertexShaderId, GLuint fragmentShaderId);
 GLint validateProgram(GLuint programObjectId);
+void bindProgramResources(ShaderProgram& program);
 
 std::string readShaderFileFromResource(const char* pFileName) {
 	std::string outFile;
@@ -108,13 +109,35 @@ GLint validateProgram(GLuint programObjectId) {
 	return Success;
 }
 
-void compileAndLinkShaders(std::string vertex_shader, std::string fragment_shader, GLuint& program) {
+// Looks up the program's samplers, uniform blocks and storage buffers, and points them at the fixed bindings.
+// These are part of the program's state, so draws never need to set them.
+void bindProgramResources(ShaderProgram& program) {
+	program.samplerLocation = glGetUniformLocation(program.program, "sampler");
+	program.environmentSamplerLocation = glGetUniformLocation(program.program, "environmentSampler");
+	program.frameUniformsBlockIndex = glGetUniformBlockIndex(program.program, "FrameUniforms");
+	program.objectsBlockIndex = glGetProgramResourceIndex(program.program, GL_SHADER_STORAGE_BLOCK, "Objects");
+	program.shaderParamsBlockIndex = glGetProgramResourceIndex(program.program, GL_SHADER_STORAGE_BLOCK, "ShaderParams");
+
+	if (program.samplerLocation != -1)
+		glProgramUniform1i(program.program, program.samplerLocation, kSamplerTextureUnit);
+	if (program.environmentSamplerLocation != -1)
+		glProgramUniform1i(program.program, program.environmentSamplerLocation, kEnvironmentSamplerTextureUnit);
+	if (program.frameUniformsBlockIndex != GL_INVALID_INDEX)
+		glUniformBlockBinding(program.program, program.frameUniformsBlockIndex, kFrameUniformsBindingPoint);
+	if (program.objectsBlockIndex != GL_INVALID_INDEX)
+		glShaderStorageBlockBinding(program.program, program.objectsBlockIndex, kObjectsBindingPoint);
+	if (program.shaderParamsBlockIndex != GL_INVALID_INDEX)
+		glShaderStorageBlockBinding(program.program, program.shaderParamsBlockIndex, kShaderParamsBindingPoint);
+}
+
+void compileAndLinkShaders(std::string vertex_shader, std::string fragment_shader, ShaderProgram& program) {
 	std::string vertexShaderSource = readShaderFileFromResource(vertex_shader.c_str());
 	std::string fragmentShaderSource = readShaderFileFromResource(fragment_shader.c_str());
 	GLuint vertexShader = compileVertexShader(vertexShaderSource.c_str());
 	GLuint fragmentShader = compileFragmentShader(fragmentShaderSource.c_str());
-	program = linkProgram(vertexShader, fragmentShader);
-	//validateProgram(program);
+	program.program = linkProgram(vertexShader, fragmentShader);
+	bindProgramResources(program);
+	//validateProgram(program.program);
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
 }
\ No newline at end of file
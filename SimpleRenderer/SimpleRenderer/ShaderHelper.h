@@ -24,10 +24,31 @@
 //GLuint linkProgram(GLuint vertexShaderId, GLuint fragmentShaderId);
 GLint validateProgram(GLuint programObjectId);
 
+// The binding points and texture units every program is linked with,
+// so buffers and textures bound to them work with any program.
+// Uniform blocks and storage buffers have separate binding points.
+const GLuint kFrameUniformsBindingPoint = 0;
+const GLuint kObjectsBindingPoint = 0;
+const GLuint kShaderParamsBindingPoint = 1;
+const GLint kSamplerTextureUnit = 0;
+const GLint kEnvironmentSamplerTextureUnit = 1;
+
+// A linked program, with what the renderer uses looked up once at link time.
+// Locations are -1, and block indices GL_INVALID_INDEX, if the program doesn't use them.
+struct ShaderProgram {
+	GLuint program;
+	GLint samplerLocation;
+	GLint environmentSamplerLocation;
+	GLuint frameUniformsBlockIndex;
+	GLuint objectsBlockIndex;
+	GLuint shaderParamsBlockIndex;
+};
+
 // Compile and link the shader programs.
 // vertex_shader is the file path to the vertex_shader code.
 // fragment_shader is the file path to the fragment_shader code.
-// program is returned by reference into last parameter.
-void compileAndLinkShaders(std::string vertex_shader, std::string fragment_shader, GLuint& program);
+// program is returned by reference into last parameter, with its uniform blocks
+// storage buffers and samplers assigned the fixed binding points and texture units above.
+void compileAndLinkShaders(std::string vertex_shader, std::string fragment_shader, ShaderProgram& program);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,163 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A packed list of entity IDs with a sparse index from
+//                entity ID to position in the list.
+//                Shared by containers that keep per entity data packed,
+//                so that they all add and remove entities the same way.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include "Utils.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+template <typename Allocator = std::allocator<size_t>>
+class SparseIndex {
+public:
+	using Vector = std::vector<size_t, Allocator>;
+
+	// Marks an entity ID as not being in the index
+	static const size_t kInvalidIndex = std::numeric_limits<size_t>::max();
+
+	// Returns true if the entity is in the index
+	bool has(size_t entityID) const
+	{
+		return entityID < m_sparse.size() && m_sparse[entityID] != kInvalidIndex;
+	}
+
+	// Returns the position of the entity in entities() without bounds checking
+	size_t indexOf(size_t entityID) const { return m_sparse[entityID]; }
+
+	// Appends the entity to the end of entities().
+	// Returns false and does nothing if the entity is already in the index.
+	bool add(size_t entityID)
+	{
+		if (entityID >= m_sparse.size())
+			m_sparse.resize(entityID + 1, kInvalidIndex);
+		return addReserved(entityID);
+	}
+
+	// Grows the sparse index to cover every entity, and makes room for
+	// them all in entities(), so that addReserved can be called for each.
+	void reserveFor(const size_t* entityIDs, size_t count)
+	{
+		size_t maxEntityID = 0;
+		for (size_t i = 0; i < count; ++i)
+			maxEntityID = std::max(maxEntityID, entityIDs[i]);
+		if (count > 0 && maxEntityID >= m_sparse.size())
+			m_sparse.resize(maxEntityID + 1, kInvalidIndex);
+		reserveMore(m_entities, count);
+	}
+
+	// As add, given that the sparse index already covers the entity
+	bool addReserved(size_t entityID)
+	{
+		if (m_sparse[entityID] != kInvalidIndex)
+			return false;
+
+		m_sparse[entityID] = m_entities.size();
+		m_entities.push_back(entityID);
+		return true;
+	}
+
+	// Removes the entity in O(1) time by moving the last entity into its place.
+	// Returns the position the entity was at, so that packed data can be moved the
+	// same way, or kInvalidIndex if the entity was not in the index.
+	size_t remove(size_t entityID)
+	{
+		if (!has(entityID))
+			return kInvalidIndex;
+
+		size_t index = m_sparse[entityID];
+		size_t movedEntityID = m_entities.back();
+		unorderedErase(m_entities, index);
+		m_sparse[movedEntityID] = index;
+		m_sparse[entityID] = kInvalidIndex;
+		return index;
+	}
+
+	// Gives the position of one entity to another entity, which must not be in the index.
+	// Does nothing if fromID is not in the index.
+	void relocate(size_t fromID, size_t toID)
+	{
+		if (!has(fromID))
+			return;
+
+		if (toID >= m_sparse.size())
+			m_sparse.resize(toID + 1, kInvalidIndex);
+
+		size_t index = m_sparse[fromID];
+		m_entities[index] = toID;
+		m_sparse[toID] = index;
+		m_sparse[fromID] = kInvalidIndex;
+	}
+
+	// Replaces the contents of the index with count entities, in order.
+	// Throws std::invalid_argument if an entity appears more than once.
+	void assign(const size_t* entities, size_t count)
+	{
+		clear();
+		m_entities.assign(entities, entities + count);
+		for (size_t i = 0; i < count; ++i) {
+			if (has(entities[i]))
+				throw std::invalid_argument("SparseIndex::assign: an entity can only appear once");
+			if (entities[i] >= m_sparse.size())
+				m_sparse.resize(entities[i] + 1, kInvalidIndex);
+			m_sparse[entities[i]] = i;
+		}
+	}
+
+	// Returns the entity IDs in the order they are packed
+	const Vector& entities() const { return m_entities; }
+
+	size_t size() const { return m_entities.size(); }
+
+	bool empty() const { return m_entities.empty(); }
+
+	// Reserves space for the specified number of entities
+	void reserve(size_t capacity) { m_entities.reserve(capacity); }
+
+	// Releases unused capacity, given that no entity ID is entityCount or above.
+	// Returns the number of bytes released.
+	size_t shrinkToFit(size_t entityCount)
+	{
+		size_t oldBytes = getCapacityBytes();
+		if (m_sparse.size() > entityCount)
+			m_sparse.resize(entityCount);
+		m_entities.shrink_to_fit();
+		m_sparse.shrink_to_fit();
+		return oldBytes - getCapacityBytes();
+	}
+
+	// Removes every entity
+	void clear()
+	{
+		m_entities.clear();
+		m_sparse.clear();
+	}
+
+private:
+	size_t getCapacityBytes() const
+	{
+		return (m_entities.capacity() + m_sparse.capacity()) * sizeof(size_t);
+	}
+
+	Vector m_entities;
+	Vector m_sparse;
+};
+
+template <typename Allocator>
+const size_t SparseIndex<Allocator>::kInvalidIndex;
@@ -0,0 +1,184 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A sparse set container used to store components.
+//                Elements are packed densely in memory and are looked up
+//                by entity ID through a sparse index.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include "PoolAllocator.h"
+#include "SparseIndex.h"
+#include "Utils.h"
+
+#include <stdexcept>
+#include <vector>
+
+// Memory for the set comes from the pool, counted as MEMORY_COMPONENTS
+template <typename T>
+class SparseSet {
+public:
+	template <typename U>
+	using Vector = PoolVector<U, Memory::MEMORY_COMPONENTS>;
+
+	using Index = SparseIndex<PoolAllocator<size_t, Memory::MEMORY_COMPONENTS>>;
+
+	// Returns true if the entity has an element in the set
+	bool has(size_t entityID) const { return m_index.has(entityID); }
+
+	// Adds a value initialized element for the entity and returns it.
+	// If the entity already has an element then the existing element is returned.
+	T& emplace(size_t entityID)
+	{
+		if (m_index.add(entityID))
+			m_dense.emplace_back();
+		return m_dense[m_index.indexOf(entityID)];
+	}
+
+	// Adds a copy of the value to the entity, overwriting any existing element.
+	T& insert(size_t entityID, const T& value)
+	{
+		T& element = emplace(entityID);
+		element = value;
+		return element;
+	}
+
+	// Adds a copy of the value to many entities, growing each array once.
+	// Entities that already have an element are overwritten.
+	void insert(const size_t* entityIDs, size_t count, const T& value)
+	{
+		reserveFor(entityIDs, count);
+		for (size_t i = 0; i < count; ++i)
+			insertReserved(entityIDs[i], value);
+	}
+
+	// Adds a copy of values[i] to entityIDs[i] for many entities, growing each array once.
+	// Entities that already have an element are overwritten.
+	void insert(const size_t* entityIDs, const T* values, size_t count)
+	{
+		reserveFor(entityIDs, count);
+		for (size_t i = 0; i < count; ++i)
+			insertReserved(entityIDs[i], values[i]);
+	}
+
+	// Removes the entity's element from the set in O(1) time.
+	// Does nothing if the entity does not have an element.
+	void remove(size_t entityID)
+	{
+		// Move the last element into the hole left by the removed element
+		size_t index = m_index.remove(entityID);
+		if (index != Index::kInvalidIndex)
+			unorderedErase(m_dense, index);
+	}
+
+	// Moves the element of one entity to another entity, which must not have an element.
+	// Does nothing if fromID does not have an element.
+	void relocate(size_t fromID, size_t toID) { m_index.relocate(fromID, toID); }
+
+	// Returns the entity's element.
+	// Throws std::out_of_range if the entity does not have an element.
+	T& at(size_t entityID)
+	{
+		if (!has(entityID))
+			throw std::out_of_range("SparseSet::at: entity does not have this component");
+		return m_dense[m_index.indexOf(entityID)];
+	}
+
+	// Returns the entity's element.
+	// Throws std::out_of_range if the entity does not have an element.
+	const T& at(size_t entityID) const
+	{
+		if (!has(entityID))
+			throw std::out_of_range("SparseSet::at: entity does not have this component");
+		return m_dense[m_index.indexOf(entityID)];
+	}
+
+	// Returns the entity's element without bounds checking
+	T& operator[](size_t entityID) { return m_dense[m_index.indexOf(entityID)]; }
+
+	// Returns the entity's element without bounds checking
+	const T& operator[](size_t entityID) const { return m_dense[m_index.indexOf(entityID)]; }
+
+	// Returns the entity IDs of the packed elements.
+	// entities()[i] is the owner of the element at begin()[i].
+	const Vector<size_t>& entities() const { return m_index.entities(); }
+
+	// Returns the number of elements in the set
+	size_t size() const { return m_dense.size(); }
+
+	bool empty() const { return m_dense.empty(); }
+
+	// Replaces the contents of the set with count elements, where values[i] belongs to entities[i].
+	// Throws std::invalid_argument if an entity appears more than once.
+	void assign(const size_t* entities, const T* values, size_t count)
+	{
+		m_dense.clear();
+		m_index.assign(entities, count);
+		m_dense.assign(values, values + count);
+	}
+
+	// Returns the packed elements.
+	// data()[i] belongs to entities()[i].
+	T* data() { return m_dense.data(); }
+	const T* data() const { return m_dense.data(); }
+
+	// Returns the number of elements the set can hold without reallocating
+	size_t capacity() const { return m_dense.capacity(); }
+
+	// Reserves space for the specified number of packed elements
+	void reserve(size_t capacity)
+	{
+		m_dense.reserve(capacity);
+		m_index.reserve(capacity);
+	}
+
+	// Releases unused capacity, given that no entity ID is entityCount or above.
+	// Returns the number of bytes released.
+	size_t shrinkToFit(size_t entityCount)
+	{
+		size_t oldBytes = m_dense.capacity() * sizeof(T);
+		m_dense.shrink_to_fit();
+		return oldBytes - m_dense.capacity() * sizeof(T) + m_index.shrinkToFit(entityCount);
+	}
+
+	// Removes all elements from the set
+	void clear()
+	{
+		m_dense.clear();
+		m_index.clear();
+	}
+
+	// Iterators over the packed elements
+	typename Vector<T>::iterator begin() { return m_dense.begin(); }
+	typename Vector<T>::iterator end() { return m_dense.end(); }
+	typename Vector<T>::const_iterator begin() const { return m_dense.begin(); }
+	typename Vector<T>::const_iterator end() const { return m_dense.end(); }
+
+private:
+	// Makes room for an element for each entity without further allocation
+	void reserveFor(const size_t* entityIDs, size_t count)
+	{
+		m_index.reserveFor(entityIDs, count);
+		reserveMore(m_dense, count);
+	}
+
+	// Inserts a value, given that reserveFor has covered the entity
+	void insertReserved(size_t entityID, const T& value)
+	{
+		if (m_index.addReserved(entityID))
+			m_dense.push_back(value);
+		else
+			m_dense[m_index.indexOf(entityID)] = value;
+	}
+
+	Vector<T> m_dense;
+	Index m_index;
+};
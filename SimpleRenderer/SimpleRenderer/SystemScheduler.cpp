@@ -0,0 +1,88 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Runs systems each frame in an order worked out from
+//                the components they read and write.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "SystemScheduler.h"
+
+#include "JobSystem.h"
+#include "Scene.h"
+
+#include <algorithm>
+
+SystemScheduler::SystemScheduler(Scene& scene, JobSystem& jobSystem)
+	: m_scene{ scene }
+	, m_jobSystem{ jobSystem }
+{
+}
+
+void SystemScheduler::addSystem(SystemDesc desc)
+{
+	m_systems.push_back(std::move(desc));
+}
+
+void SystemScheduler::run()
+{
+	buildSchedule();
+
+	// Fetch views up front, creating a view is not thread safe
+	m_systemEntities.resize(m_systems.size());
+	for (size_t i = 0; i < m_systems.size(); ++i)
+		m_systemEntities[i] = m_scene.getView(m_systems[i].componentMask).entities();
+
+	for (const std::vector<size_t>& wave : m_waves) {
+		JobGroup group;
+		for (size_t systemIdx : wave) {
+			if (m_systems[systemIdx].mainThreadOnly)
+				continue;
+
+			m_jobSystem.submit(group, [this, systemIdx]() {
+				m_systems[systemIdx].update(m_systemEntities[systemIdx]);
+			});
+		}
+
+		// Run main thread systems while the jobs are running
+		for (size_t systemIdx : wave) {
+			if (m_systems[systemIdx].mainThreadOnly)
+				m_systems[systemIdx].update(m_systemEntities[systemIdx]);
+		}
+
+		m_jobSystem.wait(group);
+	}
+}
+
+bool SystemScheduler::conflicts(const SystemDesc& lhs, const SystemDesc& rhs)
+{
+	return (lhs.writeMask & (rhs.readMask | rhs.writeMask)) != 0
+	    || (rhs.writeMask & lhs.readMask) != 0;
+}
+
+void SystemScheduler::buildSchedule()
+{
+	// A system must run after every earlier system it conflicts with,
+	// so it goes in the wave after the latest of those systems.
+	std::vector<size_t> systemWaves(m_systems.size(), 0);
+	size_t numWaves = 0;
+	for (size_t i = 0; i < m_systems.size(); ++i) {
+		for (size_t j = 0; j < i; ++j) {
+			if (conflicts(m_systems[i], m_systems[j]))
+				systemWaves[i] = std::max(systemWaves[i], systemWaves[j] + 1);
+		}
+		numWaves = std::max(numWaves, systemWaves[i] + 1);
+	}
+
+	for (auto& wave : m_waves)
+		wave.clear();
+	m_waves.resize(numWaves);
+	for (size_t i = 0; i < m_systems.size(); ++i)
+		m_waves[systemWaves[i]].push_back(i);
+}
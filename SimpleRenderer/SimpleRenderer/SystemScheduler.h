@@ -0,0 +1,80 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Runs systems each frame in an order worked out from
+//                the components they read and write.
+//                Systems that don't touch the same components are run
+//                at the same time on the job system.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include "EntityView.h"
+
+#include <functional>
+#include <vector>
+
+struct Scene;
+class JobSystem;
+
+class SystemScheduler {
+public:
+	using UpdateFunc = std::function<void(EntitySpan)>;
+
+	// Describes how a system uses the scene
+	struct SystemDesc {
+		size_t componentMask; // The components an entity needs to be updated by the system
+		size_t readMask;      // The component arrays the system reads
+		size_t writeMask;     // The component arrays the system writes
+		bool mainThreadOnly;  // True if the system must run on the thread calling run() (e.g. for GLFW or OpenGL calls)
+		UpdateFunc update;
+	};
+
+	SystemScheduler(Scene& scene, JobSystem& jobSystem);
+	SystemScheduler(const SystemScheduler&) = delete;
+	SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+	// Adds a system to the schedule.
+	// If two systems conflict, the one added first is run first.
+	void addSystem(SystemDesc desc);
+
+	// Adds a system that declares its components with the static members
+	// kComponentMask, kReadMask, kWriteMask and kMainThreadOnly.
+	template <typename SystemT>
+	void addSystem(SystemT& system)
+	{
+		addSystem(SystemDesc{
+			SystemT::kComponentMask,
+			SystemT::kReadMask,
+			SystemT::kWriteMask,
+			SystemT::kMainThreadOnly,
+			[&system](EntitySpan entities) { system.update(entities); }
+		});
+	}
+
+	// Runs every system over its entities, returning once they have all finished.
+	// Component masks must not be changed while the systems are running.
+	void run();
+
+private:
+	// Returns true if the systems can't safely run at the same time
+	static bool conflicts(const SystemDesc& lhs, const SystemDesc& rhs);
+
+	// Groups the systems into waves.
+	// Each system only depends on systems in earlier waves, so all systems
+	// in a wave can be run at the same time.
+	void buildSchedule();
+
+	Scene& m_scene;
+	JobSystem& m_jobSystem;
+	std::vector<SystemDesc> m_systems;
+	std::vector<std::vector<size_t>> m_waves;
+	std::vector<EntitySpan> m_systemEntities;
+};
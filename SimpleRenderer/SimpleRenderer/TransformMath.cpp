@@ -0,0 +1,285 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Functions for converting between matrices and
+//                position / rotation / scale transforms, including
+//                SIMD versions that work on many transforms at once.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "TransformMath.h"
+
+#include <glm\gtc\quaternion.hpp>
+
+#include <cmath>
+
+// SSE2 is always available on x64
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_MATH_SSE
+#include <xmmintrin.h>
+#endif
+
+// AVX2 code is compiled on any x86 target and only run if the CPU supports it.
+// GCC and Clang need to be told which functions may use AVX2 instructions.
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define TRANSFORM_MATH_AVX2
+#define TARGET_AVX2
+#include <immintrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define TRANSFORM_MATH_AVX2
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+#ifdef TRANSFORM_MATH_SSE
+namespace {
+	// Writes one column of four matrices.
+	// Each register holds one row of the column, with one lane per matrix.
+	void storeColumn(glm::mat4* outMatrices, size_t column, __m128& row0, __m128& row1, __m128& row2, __m128& row3)
+	{
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+		_mm_storeu_ps(&outMatrices[0][column][0], row0);
+		_mm_storeu_ps(&outMatrices[1][column][0], row1);
+		_mm_storeu_ps(&outMatrices[2][column][0], row2);
+		_mm_storeu_ps(&outMatrices[3][column][0], row3);
+	}
+}
+#endif
+
+namespace {
+	// The spin kernels rotate the rotations in [first, end) by the quaternion 
+	// (sinHalfAngle * axis, cosHalfAngle) and return the index they stopped at.
+	// SIMD kernels stop before any elements that don't fill a whole register.
+
+	size_t spinRotationsScalar(const TransformMath::QuatArrays& rotations, const TransformMath::Vec3Arrays& axes,
+	                           float sinHalfAngle, float cosHalfAngle, size_t first, size_t end)
+	{
+		for (size_t i = first; i < end; ++i) {
+			float qx = rotations.x[i];
+			float qy = rotations.y[i];
+			float qz = rotations.z[i];
+			float qw = rotations.w[i];
+			float rx = sinHalfAngle * axes.x[i];
+			float ry = sinHalfAngle * axes.y[i];
+			float rz = sinHalfAngle * axes.z[i];
+			float rw = cosHalfAngle;
+
+			float x = qw * rx + qx * rw + qy * rz - qz * ry;
+			float y = qw * ry - qx * rz + qy * rw + qz * rx;
+			float z = qw * rz + qx * ry - qy * rx + qz * rw;
+			float w = qw * rw - qx * rx - qy * ry - qz * rz;
+
+			float invLength = 1 / std::sqrt(x * x + y * y + z * z + w * w);
+			rotations.x[i] = x * invLength;
+			rotations.y[i] = y * invLength;
+			rotations.z[i] = z * invLength;
+			rotations.w[i] = w * invLength;
+		}
+		return end;
+	}
+
+#ifdef TRANSFORM_MATH_SSE
+	size_t spinRotationsSSE(const TransformMath::QuatArrays& rotations, const TransformMath::Vec3Arrays& axes,
+	                        float sinHalfAngle, float cosHalfAngle, size_t first, size_t end)
+	{
+		const __m128 s = _mm_set1_ps(sinHalfAngle);
+		const __m128 rw = _mm_set1_ps(cosHalfAngle);
+
+		size_t i = first;
+		for (; i + 4 <= end; i += 4) {
+			__m128 qx = _mm_loadu_ps(rotations.x + i);
+			__m128 qy = _mm_loadu_ps(rotations.y + i);
+			__m128 qz = _mm_loadu_ps(rotations.z + i);
+			__m128 qw = _mm_loadu_ps(rotations.w + i);
+			__m128 rx = _mm_mul_ps(s, _mm_loadu_ps(axes.x + i));
+			__m128 ry = _mm_mul_ps(s, _mm_loadu_ps(axes.y + i));
+			__m128 rz = _mm_mul_ps(s, _mm_loadu_ps(axes.z + i));
+
+			__m128 x = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qw, rx), _mm_mul_ps(qx, rw)), _mm_mul_ps(qy, rz)), _mm_mul_ps(qz, ry));
+			__m128 y = _mm_add_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(qw, ry), _mm_mul_ps(qx, rz)), _mm_mul_ps(qy, rw)), _mm_mul_ps(qz, rx));
+			__m128 z = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(qw, rz), _mm_mul_ps(qx, ry)), _mm_mul_ps(qy, rx)), _mm_mul_ps(qz, rw));
+			__m128 w = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(qw, rw), _mm_mul_ps(qx, rx)), _mm_mul_ps(qy, ry)), _mm_mul_ps(qz, rz));
+
+			__m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w)));
+			__m128 length = _mm_sqrt_ps(lengthSq);
+			_mm_storeu_ps(rotations.x + i, _mm_div_ps(x, length));
+			_mm_storeu_ps(rotations.y + i, _mm_div_ps(y, length));
+			_mm_storeu_ps(rotations.z + i, _mm_div_ps(z, length));
+			_mm_storeu_ps(rotations.w + i, _mm_div_ps(w, length));
+		}
+		return i;
+	}
+#endif
+
+#ifdef TRANSFORM_MATH_AVX2
+	TARGET_AVX2
+	size_t spinRotationsAVX2(const TransformMath::QuatArrays& rotations, const TransformMath::Vec3Arrays& axes,
+	                         float sinHalfAngle, float cosHalfAngle, size_t first, size_t end)
+	{
+		const __m256 s = _mm256_set1_ps(sinHalfAngle);
+		const __m256 rw = _mm256_set1_ps(cosHalfAngle);
+
+		size_t i = first;
+		for (; i + 8 <= end; i += 8) {
+			__m256 qx = _mm256_loadu_ps(rotations.x + i);
+			__m256 qy = _mm256_loadu_ps(rotations.y + i);
+			__m256 qz = _mm256_loadu_ps(rotations.z + i);
+			__m256 qw = _mm256_loadu_ps(rotations.w + i);
+			__m256 rx = _mm256_mul_ps(s, _mm256_loadu_ps(axes.x + i));
+			__m256 ry = _mm256_mul_ps(s, _mm256_loadu_ps(axes.y + i));
+			__m256 rz = _mm256_mul_ps(s, _mm256_loadu_ps(axes.z + i));
+
+			__m256 x = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(qw, rx), _mm256_mul_ps(qx, rw)), _mm256_mul_ps(qy, rz)), _mm256_mul_ps(qz, ry));
+			__m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(qw, ry), _mm256_mul_ps(qx, rz)), _mm256_mul_ps(qy, rw)), _mm256_mul_ps(qz, rx));
+			__m256 z = _mm256_add_ps(_mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(qw, rz), _mm256_mul_ps(qx, ry)), _mm256_mul_ps(qy, rx)), _mm256_mul_ps(qz, rw));
+			__m256 w = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(_mm256_mul_ps(qw, rw), _mm256_mul_ps(qx, rx)), _mm256_mul_ps(qy, ry)), _mm256_mul_ps(qz, rz));
+
+			__m256 lengthSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_add_ps(_mm256_mul_ps(z, z), _mm256_mul_ps(w, w)));
+			__m256 length = _mm256_sqrt_ps(lengthSq);
+			_mm256_storeu_ps(rotations.x + i, _mm256_div_ps(x, length));
+			_mm256_storeu_ps(rotations.y + i, _mm256_div_ps(y, length));
+			_mm256_storeu_ps(rotations.z + i, _mm256_div_ps(z, length));
+			_mm256_storeu_ps(rotations.w + i, _mm256_div_ps(w, length));
+		}
+		return i;
+	}
+#endif
+}
+
+glm::mat4 TransformMath::composeMatrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	float x = rotation.x;
+	float y = rotation.y;
+	float z = rotation.z;
+	float w = rotation.w;
+	float xx = 2 * x * x;
+	float yy = 2 * y * y;
+	float zz = 2 * z * z;
+	float xy = 2 * x * y;
+	float xz = 2 * x * z;
+	float yz = 2 * y * z;
+	float wx = 2 * w * x;
+	float wy = 2 * w * y;
+	float wz = 2 * w * z;
+
+	glm::mat4 matrix;
+	matrix[0] = glm::vec4{ 1 - (yy + zz), xy + wz, xz - wy, 0 } * scale.x;
+	matrix[1] = glm::vec4{ xy - wz, 1 - (xx + zz), yz + wx, 0 } * scale.y;
+	matrix[2] = glm::vec4{ xz + wy, yz - wx, 1 - (xx + yy), 0 } * scale.z;
+	matrix[3] = glm::vec4{ position, 1 };
+	return matrix;
+}
+
+void TransformMath::composeMatrices(const TRSArrays& transforms, size_t first, size_t count, glm::mat4* outMatrices)
+{
+	size_t i = first;
+	size_t end = first + count;
+
+#ifdef TRANSFORM_MATH_SSE
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 zero = _mm_setzero_ps();
+
+	// Same maths as composeMatrix, with one transform in each lane
+	for (; i + 4 <= end; i += 4) {
+		__m128 x = _mm_loadu_ps(transforms.rotationX + i);
+		__m128 y = _mm_loadu_ps(transforms.rotationY + i);
+		__m128 z = _mm_loadu_ps(transforms.rotationZ + i);
+		__m128 w = _mm_loadu_ps(transforms.rotationW + i);
+		__m128 x2 = _mm_mul_ps(x, two);
+		__m128 y2 = _mm_mul_ps(y, two);
+		__m128 z2 = _mm_mul_ps(z, two);
+		__m128 xx = _mm_mul_ps(x, x2);
+		__m128 yy = _mm_mul_ps(y, y2);
+		__m128 zz = _mm_mul_ps(z, z2);
+		__m128 xy = _mm_mul_ps(x, y2);
+		__m128 xz = _mm_mul_ps(x, z2);
+		__m128 yz = _mm_mul_ps(y, z2);
+		__m128 wx = _mm_mul_ps(w, x2);
+		__m128 wy = _mm_mul_ps(w, y2);
+		__m128 wz = _mm_mul_ps(w, z2);
+
+		__m128 scaleX = _mm_loadu_ps(transforms.scaleX + i);
+		__m128 scaleY = _mm_loadu_ps(transforms.scaleY + i);
+		__m128 scaleZ = _mm_loadu_ps(transforms.scaleZ + i);
+
+		__m128 m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), scaleX);
+		__m128 m01 = _mm_mul_ps(_mm_add_ps(xy, wz), scaleX);
+		__m128 m02 = _mm_mul_ps(_mm_sub_ps(xz, wy), scaleX);
+		__m128 m03 = zero;
+		storeColumn(outMatrices + i, 0, m00, m01, m02, m03);
+
+		__m128 m10 = _mm_mul_ps(_mm_sub_ps(xy, wz), scaleY);
+		__m128 m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), scaleY);
+		__m128 m12 = _mm_mul_ps(_mm_add_ps(yz, wx), scaleY);
+		__m128 m13 = zero;
+		storeColumn(outMatrices + i, 1, m10, m11, m12, m13);
+
+		__m128 m20 = _mm_mul_ps(_mm_add_ps(xz, wy), scaleZ);
+		__m128 m21 = _mm_mul_ps(_mm_sub_ps(yz, wx), scaleZ);
+		__m128 m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), scaleZ);
+		__m128 m23 = zero;
+		storeColumn(outMatrices + i, 2, m20, m21, m22, m23);
+
+		__m128 m30 = _mm_loadu_ps(transforms.positionX + i);
+		__m128 m31 = _mm_loadu_ps(transforms.positionY + i);
+		__m128 m32 = _mm_loadu_ps(transforms.positionZ + i);
+		__m128 m33 = one;
+		storeColumn(outMatrices + i, 3, m30, m31, m32, m33);
+	}
+#endif
+
+	// Compose any remaining matrices one at a time
+	for (; i < end; ++i) {
+		glm::vec3 position{ transforms.positionX[i], transforms.positionY[i], transforms.positionZ[i] };
+		glm::quat rotation{ transforms.rotationW[i], transforms.rotationX[i], transforms.rotationY[i], transforms.rotationZ[i] };
+		glm::vec3 scale{ transforms.scaleX[i], transforms.scaleY[i], transforms.scaleZ[i] };
+		outMatrices[i] = composeMatrix(position, rotation, scale);
+	}
+}
+
+void TransformMath::spinRotations(const QuatArrays& rotations, const Vec3Arrays& axes, float angle, size_t count)
+{
+	spinRotations(rotations, axes, angle, count, CpuFeatures::getSimdLevel());
+}
+
+void TransformMath::spinRotations(const QuatArrays& rotations, const Vec3Arrays& axes, float angle, size_t count, SimdLevel simdLevel)
+{
+	float sinHalfAngle = std::sin(angle / 2);
+	float cosHalfAngle = std::cos(angle / 2);
+
+	// Each kernel leaves any elements that don't fill a register to the next slowest kernel
+	size_t i = 0;
+#ifdef TRANSFORM_MATH_AVX2
+	if (simdLevel >= SIMD_AVX2)
+		i = spinRotationsAVX2(rotations, axes, sinHalfAngle, cosHalfAngle, i, count);
+#endif
+#ifdef TRANSFORM_MATH_SSE
+	if (simdLevel >= SIMD_SSE)
+		i = spinRotationsSSE(rotations, axes, sinHalfAngle, cosHalfAngle, i, count);
+#endif
+	spinRotationsScalar(rotations, axes, sinHalfAngle, cosHalfAngle, i, count);
+}
+
+void TransformMath::decomposeMatrix(const glm::mat4& matrix, glm::vec3& outPosition, glm::quat& outRotation, glm::vec3& outScale)
+{
+	outPosition = glm::vec3{ matrix[3] };
+
+	glm::vec3 column0{ matrix[0] };
+	glm::vec3 column1{ matrix[1] };
+	glm::vec3 column2{ matrix[2] };
+	outScale = glm::vec3{ glm::length(column0), glm::length(column1), glm::length(column2) };
+
+	// A mirrored matrix is treated as a negative scale on the x axis
+	if (glm::dot(glm::cross(column0, column1), column2) < 0)
+		outScale.x = -outScale.x;
+
+	glm::mat3 rotation{ column0 / outScale.x, column1 / outScale.y, column2 / outScale.z };
+	outRotation = glm::normalize(glm::quat_cast(rotation));
+}
@@ -0,0 +1,75 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Functions for converting between matrices and
+//                position / rotation / scale transforms, including
+//                SIMD versions that work on many transforms at once.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include "CpuFeatures.h"
+
+#include <glm\glm.hpp>
+#include <glm\fwd.hpp>
+
+namespace TransformMath {
+	// Transforms stored as one array per float, so that SIMD code
+	// can load the same float for several transforms at once.
+	struct TRSArrays {
+		const float* positionX;
+		const float* positionY;
+		const float* positionZ;
+		const float* rotationX;
+		const float* rotationY;
+		const float* rotationZ;
+		const float* rotationW;
+		const float* scaleX;
+		const float* scaleY;
+		const float* scaleZ;
+	};
+
+	// Rotations stored as one array per float
+	struct QuatArrays {
+		float* x;
+		float* y;
+		float* z;
+		float* w;
+	};
+
+	// Vectors stored as one array per float
+	struct Vec3Arrays {
+		const float* x;
+		const float* y;
+		const float* z;
+	};
+
+	// Returns the matrix translation * rotation * scale
+	glm::mat4 composeMatrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+	// Composes the matrices for transforms [first, first + count) into the same
+	// indices of outMatrices.
+	// Four matrices are composed at a time using SSE where it is available.
+	void composeMatrices(const TRSArrays& transforms, size_t first, size_t count, glm::mat4* outMatrices);
+
+	// Rotates each rotation by angle radians about its own axis, in the rotation's
+	// local space, then renormalizes it.
+	// The axes must be normalized.
+	// Uses the fastest instruction set supported by the CPU.
+	void spinRotations(const QuatArrays& rotations, const Vec3Arrays& axes, float angle, size_t count);
+
+	// As above, but using the specified instruction set.
+	// The instruction set must be supported by the CPU.
+	void spinRotations(const QuatArrays& rotations, const Vec3Arrays& axes, float angle, size_t count, SimdLevel simdLevel);
+
+	// Splits a matrix into a position, rotation and scale.
+	// Any shear in the matrix is lost.
+	void decomposeMatrix(const glm::mat4& matrix, glm::vec3& outPosition, glm::quat& outRotation, glm::vec3& outScale);
+}
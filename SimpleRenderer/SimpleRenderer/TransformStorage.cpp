@@ -0,0 +1,686 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Stores entity transforms in a parent / child hierarchy.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "TransformStorage.h"
+
+#include <glm\gtc\quaternion.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+const size_t TransformStorage::kNoParent = std::numeric_limits<size_t>::max();
+
+namespace {
+	// Marks an entity ID as not having a transform in the sparse index
+	const size_t g_kNotStored = std::numeric_limits<size_t>::max();
+
+	// The entity ID of a slot left dead by remove
+	const size_t g_kDeadSlot = std::numeric_limits<size_t>::max();
+}
+
+TransformStorage::TransformStorage()
+	: m_numDeadSlots{ 0 }
+	, m_hasDirty{ false }
+{
+}
+
+bool TransformStorage::has(size_t entityID) const
+{
+	return entityID < m_sparse.size() && m_sparse[entityID] != g_kNotStored;
+}
+
+void TransformStorage::emplace(size_t entityID)
+{
+	if (has(entityID))
+		return;
+
+	if (entityID >= m_sparse.size())
+		m_sparse.resize(entityID + 1, g_kNotStored);
+
+	// A new root can go at the end without breaking the depth first order
+	m_sparse[entityID] = m_entities.size();
+	m_entities.push_back(entityID);
+	m_positionX.push_back(0);
+	m_positionY.push_back(0);
+	m_positionZ.push_back(0);
+	m_rotationX.push_back(0);
+	m_rotationY.push_back(0);
+	m_rotationZ.push_back(0);
+	m_rotationW.push_back(1);
+	m_scaleX.push_back(1);
+	m_scaleY.push_back(1);
+	m_scaleZ.push_back(1);
+	m_spinAxisX.push_back(0);
+	m_spinAxisY.push_back(0);
+	m_spinAxisZ.push_back(0);
+	m_localTransforms.emplace_back(1);
+	m_worldTransforms.emplace_back(1);
+	m_previousWorldTransforms.emplace_back(1);
+	m_parentEntities.push_back(kNoParent);
+	m_dirty.push_back(1);
+	m_parentIndices.push_back(kNoParent);
+	m_subtreeSizes.push_back(1);
+	m_newEntities.push_back(entityID);
+	m_hasDirty = true;
+}
+
+void TransformStorage::emplace(const size_t* entityIDs, size_t count)
+{
+	size_t maxEntityID = 0;
+	for (size_t i = 0; i < count; ++i)
+		maxEntityID = std::max(maxEntityID, entityIDs[i]);
+	if (count > 0 && maxEntityID >= m_sparse.size())
+		m_sparse.resize(maxEntityID + 1, g_kNotStored);
+
+	// New roots go at the end, as with a single emplace
+	size_t firstIndex = m_entities.size();
+	for (size_t i = 0; i < count; ++i) {
+		if (has(entityIDs[i]))
+			continue;
+		m_sparse[entityIDs[i]] = m_entities.size();
+		m_entities.push_back(entityIDs[i]);
+		m_newEntities.push_back(entityIDs[i]);
+	}
+
+	size_t size = m_entities.size();
+	if (size == firstIndex)
+		return;
+
+	m_positionX.resize(size, 0);
+	m_positionY.resize(size, 0);
+	m_positionZ.resize(size, 0);
+	m_rotationX.resize(size, 0);
+	m_rotationY.resize(size, 0);
+	m_rotationZ.resize(size, 0);
+	m_rotationW.resize(size, 1);
+	m_scaleX.resize(size, 1);
+	m_scaleY.resize(size, 1);
+	m_scaleZ.resize(size, 1);
+	m_spinAxisX.resize(size, 0);
+	m_spinAxisY.resize(size, 0);
+	m_spinAxisZ.resize(size, 0);
+	m_localTransforms.resize(size, glm::mat4{ 1 });
+	m_worldTransforms.resize(size, glm::mat4{ 1 });
+	m_previousWorldTransforms.resize(size, glm::mat4{ 1 });
+	m_parentEntities.resize(size, kNoParent);
+	m_dirty.resize(size, 1);
+	m_parentIndices.resize(size, kNoParent);
+	m_subtreeSizes.resize(size, 1);
+	m_hasDirty = true;
+}
+
+void TransformStorage::emplace(const size_t* entityIDs, const glm::mat4* localTransforms, size_t count)
+{
+	size_t firstIndex = m_entities.size();
+	emplace(entityIDs, count);
+
+	// New transforms are already dirty, so only the components need writing
+	for (size_t i = 0; i < count; ++i) {
+		size_t index = m_sparse[entityIDs[i]];
+		if (index < firstIndex)
+			continue;
+
+		glm::vec3 position;
+		glm::quat rotation;
+		glm::vec3 scale;
+		TransformMath::decomposeMatrix(localTransforms[i], position, rotation, scale);
+		m_positionX[index] = position.x;
+		m_positionY[index] = position.y;
+		m_positionZ[index] = position.z;
+		m_rotationX[index] = rotation.x;
+		m_rotationY[index] = rotation.y;
+		m_rotationZ[index] = rotation.z;
+		m_rotationW[index] = rotation.w;
+		m_scaleX[index] = scale.x;
+		m_scaleY[index] = scale.y;
+		m_scaleZ[index] = scale.z;
+	}
+}
+
+void TransformStorage::reserve(size_t capacity)
+{
+	forEachArray([capacity](auto& v) {
+		v.reserve(capacity);
+	});
+	m_parentIndices.reserve(capacity);
+	m_subtreeSizes.reserve(capacity);
+}
+
+size_t TransformStorage::capacity() const
+{
+	return m_entities.capacity();
+}
+
+void TransformStorage::remove(size_t entityID)
+{
+	if (!has(entityID))
+		return;
+
+	size_t index = getIndex(entityID);
+	m_sparse[entityID] = g_kNotStored;
+
+	// Roots can be in any order, so a lone root can take the place of another
+	size_t last = m_entities.size() - 1;
+	if (isLoneRoot(index) && isLoneRoot(last)) {
+		forEachArray([index, last](auto& v) {
+			v[index] = v[last];
+			v.pop_back();
+		});
+		m_parentIndices.pop_back();
+		m_subtreeSizes.pop_back();
+		if (index != last && m_entities[index] != g_kDeadSlot)
+			m_sparse[m_entities[index]] = index;
+		return;
+	}
+
+	// Detach children, keeping them where they are in the world.
+	// They stay inside the dead slot's subtree until the dead slots are removed.
+	glm::mat4 world = computeWorld(index);
+	for (size_t i = index + 1; i < index + m_subtreeSizes[index]; ++i) {
+		if (m_parentEntities[i] == entityID) {
+			m_parentEntities[i] = kNoParent;
+			setLocal(m_entities[i], world * getLocalAt(i));
+		}
+	}
+
+	m_entities[index] = g_kDeadSlot;
+	m_spinAxisX[index] = 0;
+	m_spinAxisY[index] = 0;
+	m_spinAxisZ[index] = 0;
+	m_dirty[index] = 0;
+	++m_numDeadSlots;
+}
+
+void TransformStorage::setParent(size_t entityID, size_t parentEntityID)
+{
+	// The hierarchy is rebuilt below, which needs every subtree to be contiguous
+	removeDeadSlots();
+
+	size_t index = getIndex(entityID);
+	size_t count = m_subtreeSizes[index];
+
+	// The subtree is moved to the end of the new parent's subtree,
+	// or the end of the storage if it is becoming a root
+	size_t dest = m_entities.size();
+	if (parentEntityID != kNoParent) {
+		size_t parentIndex = getIndex(parentEntityID);
+		if (parentIndex >= index && parentIndex < index + count)
+			throw std::invalid_argument("TransformStorage::setParent: an entity can't be attached to itself or its descendants");
+		dest = parentIndex + m_subtreeSizes[parentIndex];
+	}
+
+	size_t newIndex = (dest > index) ? dest - count : dest;
+	moveBlock(index, count, newIndex);
+	m_parentEntities[newIndex] = parentEntityID;
+	markDirty(newIndex);
+
+	rebuildHierarchy();
+}
+
+size_t TransformStorage::getParent(size_t entityID) const
+{
+	return m_parentEntities[getIndex(entityID)];
+}
+
+glm::mat4 TransformStorage::getLocal(size_t entityID) const
+{
+	return getLocalAt(getIndex(entityID));
+}
+
+void TransformStorage::setLocal(size_t entityID, const glm::mat4& localTransform)
+{
+	glm::vec3 position;
+	glm::quat rotation;
+	glm::vec3 scale;
+	TransformMath::decomposeMatrix(localTransform, position, rotation, scale);
+	setPosition(entityID, position);
+	setRotation(entityID, rotation);
+	setScale(entityID, scale);
+}
+
+glm::vec3 TransformStorage::getPosition(size_t entityID) const
+{
+	size_t index = getIndex(entityID);
+	return glm::vec3{ m_positionX[index], m_positionY[index], m_positionZ[index] };
+}
+
+glm::quat TransformStorage::getRotation(size_t entityID) const
+{
+	size_t index = getIndex(entityID);
+	return glm::quat{ m_rotationW[index], m_rotationX[index], m_rotationY[index], m_rotationZ[index] };
+}
+
+glm::vec3 TransformStorage::getScale(size_t entityID) const
+{
+	size_t index = getIndex(entityID);
+	return glm::vec3{ m_scaleX[index], m_scaleY[index], m_scaleZ[index] };
+}
+
+void TransformStorage::setPosition(size_t entityID, const glm::vec3& position)
+{
+	size_t index = getIndex(entityID);
+	m_positionX[index] = position.x;
+	m_positionY[index] = position.y;
+	m_positionZ[index] = position.z;
+	markDirty(index);
+}
+
+void TransformStorage::setRotation(size_t entityID, const glm::quat& rotation)
+{
+	size_t index = getIndex(entityID);
+	m_rotationX[index] = rotation.x;
+	m_rotationY[index] = rotation.y;
+	m_rotationZ[index] = rotation.z;
+	m_rotationW[index] = rotation.w;
+	markDirty(index);
+}
+
+void TransformStorage::setScale(size_t entityID, const glm::vec3& scale)
+{
+	size_t index = getIndex(entityID);
+	m_scaleX[index] = scale.x;
+	m_scaleY[index] = scale.y;
+	m_scaleZ[index] = scale.z;
+	markDirty(index);
+}
+
+void TransformStorage::setSpinAxis(size_t entityID, const glm::vec3& axis)
+{
+	size_t index = getIndex(entityID);
+	glm::vec3 normalizedAxis = (axis == glm::vec3{ 0 }) ? axis : glm::normalize(axis);
+	m_spinAxisX[index] = normalizedAxis.x;
+	m_spinAxisY[index] = normalizedAxis.y;
+	m_spinAxisZ[index] = normalizedAxis.z;
+}
+
+void TransformStorage::spin(float angle, size_t first, size_t count)
+{
+	size_t end = std::min(first + count, m_entities.size());
+	size_t runStart = first;
+	while (runStart < end) {
+		// Find the next run of spinning transforms
+		while (runStart < end && !isSpinning(runStart))
+			++runStart;
+		size_t runEnd = runStart;
+		while (runEnd < end && isSpinning(runEnd))
+			++runEnd;
+		if (runStart == runEnd)
+			break;
+
+		TransformMath::QuatArrays rotations{ &m_rotationX[runStart], &m_rotationY[runStart], &m_rotationZ[runStart], &m_rotationW[runStart] };
+		TransformMath::Vec3Arrays axes{ &m_spinAxisX[runStart], &m_spinAxisY[runStart], &m_spinAxisZ[runStart] };
+		TransformMath::spinRotations(rotations, axes, angle, runEnd - runStart);
+		markDirty(runStart, runEnd - runStart);
+		runStart = runEnd;
+	}
+}
+
+const glm::mat4& TransformStorage::getWorld(size_t entityID) const
+{
+	return m_worldTransforms[getIndex(entityID)];
+}
+
+const glm::mat4& TransformStorage::getPreviousWorld(size_t entityID) const
+{
+	return m_previousWorldTransforms[getIndex(entityID)];
+}
+
+void TransformStorage::updateWorldTransforms()
+{
+	// Transforms that changed last time are now at rest, unless they are changed again below.
+	// The entities may have lost their transforms since.
+	for (size_t entityID : m_changedEntities) {
+		if (has(entityID)) {
+			size_t index = getIndex(entityID);
+			m_previousWorldTransforms[index] = m_worldTransforms[index];
+		}
+	}
+	m_changedEntities.clear();
+	if (!m_hasDirty)
+		return;
+
+	// Build local matrices for runs of blocks that contain a dirty transform.
+	// Whole blocks are composed so the SIMD kernel can do four transforms at a time.
+	const size_t kBlockSize = 4;
+	TransformMath::TRSArrays trs = getTRSArrays();
+	size_t runStart = m_entities.size();
+	for (size_t blockStart = 0; blockStart < m_entities.size(); blockStart += kBlockSize) {
+		size_t blockEnd = std::min(blockStart + kBlockSize, m_entities.size());
+		bool isBlockDirty = std::find(m_dirty.begin() + blockStart, m_dirty.begin() + blockEnd, static_cast<uint8_t>(1)) != m_dirty.begin() + blockEnd;
+		if (isBlockDirty && runStart == m_entities.size()) {
+			runStart = blockStart;
+		}
+		else if (!isBlockDirty && runStart != m_entities.size()) {
+			TransformMath::composeMatrices(trs, runStart, blockStart - runStart, m_localTransforms.data());
+			runStart = m_entities.size();
+		}
+	}
+	if (runStart != m_entities.size())
+		TransformMath::composeMatrices(trs, runStart, m_entities.size() - runStart, m_localTransforms.data());
+
+	// Parents come before their children, so a parent's world transform is
+	// always up to date by the time its children are reached
+	for (size_t i = 0; i < m_entities.size(); ++i) {
+		if (m_entities[i] == g_kDeadSlot)
+			continue;
+
+		// Children detached from a dead slot are still inside its subtree, but are roots
+		size_t parentIndex = (m_parentEntities[i] == kNoParent) ? kNoParent : m_parentIndices[i];
+		// Children of a dirty transform are dirty too
+		if (parentIndex != kNoParent && m_dirty[parentIndex])
+			m_dirty[i] = 1;
+		if (!m_dirty[i])
+			continue;
+
+		if (parentIndex == kNoParent)
+			m_worldTransforms[i] = m_localTransforms[i];
+		else
+			m_worldTransforms[i] = m_worldTransforms[parentIndex] * m_localTransforms[i];
+		m_changedEntities.push_back(m_entities[i]);
+	}
+
+	// New transforms start at rest where they were placed
+	for (size_t entityID : m_newEntities) {
+		if (has(entityID)) {
+			size_t index = getIndex(entityID);
+			m_previousWorldTransforms[index] = m_worldTransforms[index];
+		}
+	}
+	m_newEntities.clear();
+
+	std::fill(m_dirty.begin(), m_dirty.end(), static_cast<uint8_t>(0));
+	m_hasDirty = false;
+}
+
+const TransformStorage::Vector<size_t>& TransformStorage::getChangedEntities() const
+{
+	return m_changedEntities;
+}
+
+const TransformStorage::Vector<size_t>& TransformStorage::entities() const
+{
+	return m_entities;
+}
+
+const TransformStorage::Vector<size_t>& TransformStorage::parents() const
+{
+	return m_parentEntities;
+}
+
+void TransformStorage::getLiveOrder(std::vector<size_t>& outIndices) const
+{
+	// Group the transforms by the root they are relative to, keeping their order within each group.
+	// Each group is then a subtree in depth first order.
+	size_t count = m_entities.size();
+	std::vector<size_t> roots(count, kNoParent);
+	std::vector<size_t> groupOffsets(count, 0);
+	for (size_t i = 0; i < count; ++i) {
+		if (m_entities[i] == g_kDeadSlot)
+			continue;
+		roots[i] = (m_parentEntities[i] == kNoParent) ? i : roots[m_parentIndices[i]];
+		++groupOffsets[roots[i]];
+	}
+
+	size_t offset = 0;
+	for (size_t& groupOffset : groupOffsets) {
+		size_t groupSize = groupOffset;
+		groupOffset = offset;
+		offset += groupSize;
+	}
+
+	outIndices.resize(offset);
+	for (size_t i = 0; i < count; ++i) {
+		if (m_entities[i] != g_kDeadSlot)
+			outIndices[groupOffsets[roots[i]]++] = i;
+	}
+}
+
+TransformMath::TRSArrays TransformStorage::getTRSArrays() const
+{
+	return TransformMath::TRSArrays{
+		m_positionX.data(), m_positionY.data(), m_positionZ.data(),
+		m_rotationX.data(), m_rotationY.data(), m_rotationZ.data(), m_rotationW.data(),
+		m_scaleX.data(), m_scaleY.data(), m_scaleZ.data()
+	};
+}
+
+void TransformStorage::assign(const size_t* entities, const size_t* parents, const TransformMath::TRSArrays& transforms, size_t count)
+{
+	m_entities.assign(entities, entities + count);
+	m_parentEntities.assign(parents, parents + count);
+	m_positionX.assign(transforms.positionX, transforms.positionX + count);
+	m_positionY.assign(transforms.positionY, transforms.positionY + count);
+	m_positionZ.assign(transforms.positionZ, transforms.positionZ + count);
+	m_rotationX.assign(transforms.rotationX, transforms.rotationX + count);
+	m_rotationY.assign(transforms.rotationY, transforms.rotationY + count);
+	m_rotationZ.assign(transforms.rotationZ, transforms.rotationZ + count);
+	m_rotationW.assign(transforms.rotationW, transforms.rotationW + count);
+	m_scaleX.assign(transforms.scaleX, transforms.scaleX + count);
+	m_scaleY.assign(transforms.scaleY, transforms.scaleY + count);
+	m_scaleZ.assign(transforms.scaleZ, transforms.scaleZ + count);
+	m_spinAxisX.assign(count, 0);
+	m_spinAxisY.assign(count, 0);
+	m_spinAxisZ.assign(count, 0);
+	m_localTransforms.assign(count, glm::mat4{ 1 });
+	m_worldTransforms.assign(count, glm::mat4{ 1 });
+	m_previousWorldTransforms.assign(count, glm::mat4{ 1 });
+	m_changedEntities.clear();
+	m_newEntities.assign(entities, entities + count);
+	m_dirty.assign(count, 1);
+	m_numDeadSlots = 0;
+	m_hasDirty = true;
+
+	m_sparse.clear();
+	for (size_t i = 0; i < count; ++i) {
+		if (has(entities[i]))
+			throw std::invalid_argument("TransformStorage::assign: an entity can only have one transform");
+		if (entities[i] >= m_sparse.size())
+			m_sparse.resize(entities[i] + 1, g_kNotStored);
+		m_sparse[entities[i]] = i;
+	}
+
+	// Parents must come before their children, with each subtree stored contiguously
+	for (size_t i = 0; i < count; ++i) {
+		if (parents[i] != kNoParent && (!has(parents[i]) || m_sparse[parents[i]] >= i))
+			throw std::invalid_argument("TransformStorage::assign: transforms are not in depth first order");
+	}
+	rebuildHierarchy();
+	for (size_t i = 0; i < count; ++i) {
+		size_t parentIndex = m_parentIndices[i];
+		if (parentIndex != kNoParent && i >= parentIndex + m_subtreeSizes[parentIndex])
+			throw std::invalid_argument("TransformStorage::assign: transforms are not in depth first order");
+	}
+}
+
+size_t TransformStorage::size() const
+{
+	return m_entities.size();
+}
+
+void TransformStorage::relocate(const size_t* fromIDs, const size_t* toIDs, size_t count)
+{
+	if (count == 0)
+		return;
+
+	for (size_t i = 0; i < count; ++i) {
+		if (!has(fromIDs[i]))
+			continue;
+
+		size_t index = getIndex(fromIDs[i]);
+		if (toIDs[i] >= m_sparse.size())
+			m_sparse.resize(toIDs[i] + 1, g_kNotStored);
+		m_entities[index] = toIDs[i];
+		m_sparse[toIDs[i]] = index;
+		m_sparse[fromIDs[i]] = g_kNotStored;
+
+		// Children are always inside their parent's subtree
+		for (size_t child = index + 1; child < index + m_subtreeSizes[index]; ++child) {
+			if (m_parentEntities[child] == fromIDs[i])
+				m_parentEntities[child] = toIDs[i];
+		}
+	}
+
+	// Lists of entity IDs kept between updates are remapped in one pass
+	std::vector<std::pair<size_t, size_t>> moves(count);
+	for (size_t i = 0; i < count; ++i)
+		moves[i] = { fromIDs[i], toIDs[i] };
+	std::sort(moves.begin(), moves.end());
+	auto remap = [&moves](size_t& entityID) {
+		auto it = std::lower_bound(moves.begin(), moves.end(), std::make_pair(entityID, static_cast<size_t>(0)));
+		if (it != moves.end() && it->first == entityID)
+			entityID = it->second;
+	};
+	for (size_t& entityID : m_changedEntities)
+		remap(entityID);
+	for (size_t& entityID : m_newEntities)
+		remap(entityID);
+}
+
+size_t TransformStorage::shrinkToFit(size_t entityCount)
+{
+	removeDeadSlots();
+
+	size_t oldBytes = getCapacityBytes();
+	if (m_sparse.size() > entityCount)
+		m_sparse.resize(entityCount);
+	forEachArray([](auto& v) {
+		v.shrink_to_fit();
+	});
+	m_parentIndices.shrink_to_fit();
+	m_subtreeSizes.shrink_to_fit();
+	m_sparse.shrink_to_fit();
+	m_changedEntities.shrink_to_fit();
+	m_newEntities.shrink_to_fit();
+	return oldBytes - getCapacityBytes();
+}
+
+size_t TransformStorage::getCapacityBytes()
+{
+	size_t bytes = 0;
+	auto addBytes = [&bytes](const auto& v) {
+		bytes += v.capacity() * sizeof(v[0]);
+	};
+	forEachArray(addBytes);
+	addBytes(m_parentIndices);
+	addBytes(m_subtreeSizes);
+	addBytes(m_sparse);
+	addBytes(m_changedEntities);
+	addBytes(m_newEntities);
+	return bytes;
+}
+
+size_t TransformStorage::getIndex(size_t entityID) const
+{
+	if (!has(entityID))
+		throw std::out_of_range("TransformStorage: entity does not have a transform");
+	return m_sparse[entityID];
+}
+
+void TransformStorage::moveBlock(size_t first, size_t count, size_t dest)
+{
+	if (dest == first)
+		return;
+
+	size_t rotateFirst = std::min(first, dest);
+	size_t rotateMiddle = (dest < first) ? first : first + count;
+	size_t rotateLast = std::max(first, dest) + count;
+	forEachArray([rotateFirst, rotateMiddle, rotateLast](auto& v) {
+		std::rotate(v.begin() + rotateFirst, v.begin() + rotateMiddle, v.begin() + rotateLast);
+	});
+}
+
+void TransformStorage::markDirty(size_t index)
+{
+	m_dirty[index] = 1;
+
+	// Avoid writing to the shared flag when it is already set
+	if (!m_hasDirty.load(std::memory_order_relaxed))
+		m_hasDirty.store(true, std::memory_order_relaxed);
+}
+
+void TransformStorage::markDirty(size_t first, size_t count)
+{
+	std::fill(m_dirty.begin() + first, m_dirty.begin() + first + count, static_cast<uint8_t>(1));
+
+	if (count > 0 && !m_hasDirty.load(std::memory_order_relaxed))
+		m_hasDirty.store(true, std::memory_order_relaxed);
+}
+
+bool TransformStorage::isSpinning(size_t index) const
+{
+	return m_spinAxisX[index] != 0 || m_spinAxisY[index] != 0 || m_spinAxisZ[index] != 0;
+}
+
+glm::mat4 TransformStorage::getLocalAt(size_t index) const
+{
+	glm::vec3 position{ m_positionX[index], m_positionY[index], m_positionZ[index] };
+	glm::quat rotation{ m_rotationW[index], m_rotationX[index], m_rotationY[index], m_rotationZ[index] };
+	glm::vec3 scale{ m_scaleX[index], m_scaleY[index], m_scaleZ[index] };
+	return TransformMath::composeMatrix(position, rotation, scale);
+}
+
+glm::mat4 TransformStorage::computeWorld(size_t index) const
+{
+	glm::mat4 world = getLocalAt(index);
+	for (size_t i = index; m_parentEntities[i] != kNoParent;) {
+		i = m_parentIndices[i];
+		world = getLocalAt(i) * world;
+	}
+	return world;
+}
+
+bool TransformStorage::isLoneRoot(size_t index) const
+{
+	return m_parentIndices[index] == kNoParent && m_subtreeSizes[index] == 1;
+}
+
+void TransformStorage::removeDeadSlots()
+{
+	if (m_numDeadSlots == 0)
+		return;
+
+	std::vector<size_t> order;
+	getLiveOrder(order);
+	forEachArray([&order](auto& v) {
+		std::remove_reference_t<decltype(v)> live;
+		live.reserve(v.capacity());
+		for (size_t index : order)
+			live.push_back(v[index]);
+		v.swap(live);
+	});
+	m_numDeadSlots = 0;
+
+	rebuildHierarchy();
+}
+
+void TransformStorage::rebuildHierarchy()
+{
+	for (size_t i = 0; i < m_entities.size(); ++i)
+		m_sparse[m_entities[i]] = i;
+
+	m_parentIndices.resize(m_entities.size());
+	for (size_t i = 0; i < m_entities.size(); ++i) {
+		size_t parentID = m_parentEntities[i];
+		m_parentIndices[i] = (parentID == kNoParent) ? kNoParent : m_sparse[parentID];
+	}
+
+	// Walk backwards so that each subtree is complete before it is added to its parent
+	m_subtreeSizes.assign(m_entities.size(), 1);
+	for (size_t i = m_entities.size(); i-- > 0;) {
+		if (m_parentIndices[i] != kNoParent)
+			m_subtreeSizes[m_parentIndices[i]] += m_subtreeSizes[i];
+	}
+}
@@ -0,0 +1,265 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : Stores entity transforms in a parent / child hierarchy.
+//                Transforms are kept sorted depth first, so parents always
+//                come before their children and world matrices can be
+//                updated in a single linear pass.
+//                Local transforms are stored as position, rotation and
+//                scale, with one array per float so that local matrices
+//                can be built for many transforms at once with SIMD.
+//                Memory comes from the pool, counted as MEMORY_TRANSFORMS.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include "PoolAllocator.h"
+#include "TransformMath.h"
+
+#include <glm\glm.hpp>
+#include <glm\fwd.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class TransformStorage {
+public:
+	template <typename T>
+	using Vector = PoolVector<T, Memory::MEMORY_TRANSFORMS>;
+
+	// The parent of an entity that is not attached to anything
+	static const size_t kNoParent;
+
+	TransformStorage();
+	TransformStorage(const TransformStorage&) = delete;
+	TransformStorage& operator=(const TransformStorage&) = delete;
+
+	// Returns true if the entity has a transform
+	bool has(size_t entityID) const;
+
+	// Adds an identity transform with no parent to the entity.
+	// Does nothing if the entity already has a transform.
+	void emplace(size_t entityID);
+
+	// Adds identity transforms to many entities, growing each array once.
+	// Entities that already have a transform are skipped.
+	void emplace(const size_t* entityIDs, size_t count);
+
+	// Adds transforms with no parent to many entities, decomposing localTransforms[i]
+	// straight into the transform of entityIDs[i].
+	// Entities that already have a transform are skipped.
+	void emplace(const size_t* entityIDs, const glm::mat4* localTransforms, size_t count);
+
+	// Reserves space for the specified number of transforms
+	void reserve(size_t capacity);
+
+	// Returns the number of transforms that fit without reallocating
+	size_t capacity() const;
+
+	// Removes the entity's transform.
+	// Children of the entity are detached, keeping their current world transform.
+	// A root with no children is swapped with the last transform if that is one too.
+	// Anything else leaves a dead slot in place until shrinkToFit or setParent,
+	// so removing never rebuilds the hierarchy.
+	void remove(size_t entityID);
+
+	// Attaches the entity to a parent, its local transform becomes relative to the parent.
+	// Pass kNoParent to detach the entity.
+	// Throws std::invalid_argument if the parent is the entity or one of its descendants.
+	void setParent(size_t entityID, size_t parentEntityID);
+
+	// Returns the entity's parent, or kNoParent if it has none
+	size_t getParent(size_t entityID) const;
+
+	// Returns the transform relative to the entity's parent as a matrix
+	glm::mat4 getLocal(size_t entityID) const;
+
+	// Sets the transform relative to the entity's parent from a matrix.
+	// Any shear in the matrix is lost.
+	void setLocal(size_t entityID, const glm::mat4& localTransform);
+
+	// Gets / sets the parts of the transform relative to the entity's parent.
+	// The world transforms of the entity and its children are updated by the next
+	// call to updateWorldTransforms.
+	// Setters are safe to call from multiple threads as long as each thread sets
+	// different entities.
+	glm::vec3 getPosition(size_t entityID) const;
+	glm::quat getRotation(size_t entityID) const;
+	glm::vec3 getScale(size_t entityID) const;
+	void setPosition(size_t entityID, const glm::vec3& position);
+	void setRotation(size_t entityID, const glm::quat& rotation);
+	void setScale(size_t entityID, const glm::vec3& scale);
+
+	// Sets the axis, in the entity's local space, that spin rotates its transform about.
+	// The axis is normalized when it is stored. A zero axis stops the transform spinning.
+	// New transforms don't spin.
+	void setSpinAxis(size_t entityID, const glm::vec3& axis);
+
+	// Rotates each spinning transform in [first, first + count) of entities() by angle
+	// radians about its spin axis.
+	// The SIMD spin kernel runs straight on the rotation arrays, and each run of
+	// spinning transforms is marked dirty at once.
+	// Safe to call from multiple threads as long as the ranges don't overlap.
+	void spin(float angle, size_t first, size_t count);
+
+	// Returns the entity's world transform as of the last call to updateWorldTransforms
+	const glm::mat4& getWorld(size_t entityID) const;
+
+	// Returns the entity's world transform from before the last call to updateWorldTransforms.
+	// This is the same as getWorld if the transform didn't change, and is used to
+	// interpolate between simulation steps.
+	const glm::mat4& getPreviousWorld(size_t entityID) const;
+
+	// Recalculates world transforms for every subtree that has changed.
+	// Local matrices are built in batches for the transforms that have changed.
+	// Does no work if no transforms have changed.
+	void updateWorldTransforms();
+
+	// Returns the entities whose world transforms were recalculated by the
+	// last call to updateWorldTransforms
+	const Vector<size_t>& getChangedEntities() const;
+
+	// Returns the entity IDs in depth first order.
+	// Dead slots left by remove hold kNoParent, use getLiveOrder to skip them.
+	const Vector<size_t>& entities() const;
+
+	// Returns the parent of each entity in entities(), or kNoParent
+	const Vector<size_t>& parents() const;
+
+	// Gets the indices into entities() of every live transform, in an order
+	// that is depth first once the dead slots are left out.
+	void getLiveOrder(std::vector<size_t>& outIndices) const;
+
+	// Returns pointers to the position, rotation and scale arrays.
+	// Element i belongs to entities()[i].
+	TransformMath::TRSArrays getTRSArrays() const;
+
+	// Replaces every transform with count transforms, where element i of each
+	// array belongs to entities[i].
+	// The transforms must be in depth first order, as returned by entities().
+	// Throws std::invalid_argument if they are not.
+	void assign(const size_t* entities, const size_t* parents, const TransformMath::TRSArrays& transforms, size_t count);
+
+	size_t size() const;
+
+	// Moves the transforms of the entities fromIDs[i] to the entities toIDs[i],
+	// which must not have transforms. Children stay attached.
+	void relocate(const size_t* fromIDs, const size_t* toIDs, size_t count);
+
+	// Removes dead slots and releases unused capacity, given that no entity ID
+	// is entityCount or above.
+	// Returns the number of bytes released.
+	size_t shrinkToFit(size_t entityCount);
+
+private:
+	// Returns the index of the entity's transform in the dense arrays.
+	// Throws std::out_of_range if the entity has no transform.
+	size_t getIndex(size_t entityID) const;
+
+	// Moves the block of count transforms starting at first so that it starts at dest,
+	// shifting the transforms in between.
+	void moveBlock(size_t first, size_t count, size_t dest);
+
+	// Returns the bytes allocated by every array
+	size_t getCapacityBytes();
+
+	// Flags the transform at the index as changed
+	void markDirty(size_t index);
+
+	// Flags the transforms [first, first + count) as changed
+	void markDirty(size_t first, size_t count);
+
+	// Returns true if the transform at the index has a spin axis
+	bool isSpinning(size_t index) const;
+
+	// Returns the transform at the index relative to its parent
+	glm::mat4 getLocalAt(size_t index) const;
+
+	// Returns the world transform at the index from the local transforms,
+	// which is current even before updateWorldTransforms is called
+	glm::mat4 computeWorld(size_t index) const;
+
+	// Returns true if the transform at the index is a root with no children
+	bool isLoneRoot(size_t index) const;
+
+	// Erases the dead slots left by remove, moving their detached children after
+	// the rest so that every subtree is contiguous again
+	void removeDeadSlots();
+
+	// Calls func on each array that is sorted depth first
+	template <typename Func>
+	void forEachArray(Func func)
+	{
+		func(m_entities);
+		func(m_positionX);
+		func(m_positionY);
+		func(m_positionZ);
+		func(m_rotationX);
+		func(m_rotationY);
+		func(m_rotationZ);
+		func(m_rotationW);
+		func(m_scaleX);
+		func(m_scaleY);
+		func(m_scaleZ);
+		func(m_spinAxisX);
+		func(m_spinAxisY);
+		func(m_spinAxisZ);
+		func(m_localTransforms);
+		func(m_worldTransforms);
+		func(m_previousWorldTransforms);
+		func(m_parentEntities);
+		func(m_dirty);
+	}
+
+	// Rebuilds the parent indices, subtree sizes and sparse index
+	// after the order of the transforms has changed.
+	void rebuildHierarchy();
+
+	// Sorted depth first, a subtree is stored as a contiguous block starting with its root
+	Vector<size_t> m_entities;
+	Vector<float> m_positionX;
+	Vector<float> m_positionY;
+	Vector<float> m_positionZ;
+	Vector<float> m_rotationX;
+	Vector<float> m_rotationY;
+	Vector<float> m_rotationZ;
+	Vector<float> m_rotationW;
+	Vector<float> m_scaleX;
+	Vector<float> m_scaleY;
+	Vector<float> m_scaleZ;
+	Vector<float> m_spinAxisX; // Normalized, or zero for transforms that don't spin
+	Vector<float> m_spinAxisY;
+	Vector<float> m_spinAxisZ;
+	Vector<glm::mat4> m_localTransforms; // Built from the position, rotation and scale
+	Vector<glm::mat4> m_worldTransforms;
+	Vector<glm::mat4> m_previousWorldTransforms; // Only differ from the world transforms for m_changedEntities
+	Vector<size_t> m_parentEntities;
+	Vector<uint8_t> m_dirty; // Not vector<bool> so entities can be marked dirty concurrently
+
+	// Derived from the above by rebuildHierarchy.
+	// Dead slots keep their place in the hierarchy, so the parent index of a child
+	// detached from one still points at it even though its parent entity is kNoParent.
+	Vector<size_t> m_parentIndices;
+	Vector<size_t> m_subtreeSizes;
+	Vector<size_t> m_sparse;
+
+	// The number of slots in the arrays left dead by remove
+	size_t m_numDeadSlots;
+
+	Vector<size_t> m_changedEntities;
+
+	// Entities given a transform since the last call to updateWorldTransforms.
+	// These have no previous world transform to interpolate from.
+	Vector<size_t> m_newEntities;
+
+	// True if any transform is dirty
+	std::atomic<bool> m_hasDirty;
+};
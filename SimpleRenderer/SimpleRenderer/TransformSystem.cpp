@@ -0,0 +1,31 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A system which updates world transforms from the
+//                transform hierarchy.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#include "TransformSystem.h"
+
+#include "SceneUtils.h"
+
+TransformSystem::TransformSystem(Scene& scene)
+	: m_scene{ scene }
+{
+}
+
+void TransformSystem::update(EntitySpan)
+{
+	m_scene.transformComponents.updateWorldTransforms();
+
+	// Let the renderer know which model matrices need to be uploaded
+	for (size_t entityID : m_scene.transformComponents.getChangedEntities())
+		SceneUtils::markChanged(m_scene, entityID, COMPONENT_TRANSFORM);
+}
@@ -0,0 +1,40 @@
+//
+// Bachelor of Software Engineering
+// Media Design School
+// Auckland
+// New Zealand
+//
+// (c) 2017 Media Design School
+//
+// Description  : A system which updates world transforms from the
+//                transform hierarchy.
+// Author       : Lance Chaney
+// Mail         : lance.cha7337@mediadesign.school.nz
+//
+
+#pragma once
+
+#include "Scene.h"
+
+class TransformSystem {
+public:
+	TransformSystem(Scene& scene);
+
+	// The components an entity needs to have its world transform updated
+	static const size_t kComponentMask = COMPONENT_TRANSFORM;
+
+	// The components used by update, for scheduling
+	static const size_t kReadMask = COMPONENT_TRANSFORM;
+	static const size_t kWriteMask = COMPONENT_TRANSFORM;
+	static const bool kMainThreadOnly = false;
+
+	// Updates the world transforms of all entities whose local transforms,
+	// or whose ancestors' local transforms, have changed.
+	// Entities whose world transforms change are marked as changed in the scene.
+	// The whole hierarchy is updated regardless of the entities passed in,
+	// as world transforms depend on the entity's parents.
+	void update(EntitySpan entities);
+
+private:
+	Scene& m_scene;
+};
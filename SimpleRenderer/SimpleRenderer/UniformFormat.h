@@ -6,10 +6,9 @@
 //
 // (c) 2017 Media Design School
 //
-// Description  : A struct containing model, view and projection matrices
-//                as well as camera position.
-//                Corresponds to an equivalent uniform buffer object on the
-//                GPU with same alignment.
+// Description  : The blocks of data shared by the shaders.
+//                Each struct has the same layout as its block on the GPU,
+//                std140 for uniform blocks and std430 for storage buffers.
 // Author       : Lance Chaney
 // Mail         : lance.cha7337@mediadesign.school.nz
 //
@@ -18,9 +17,18 @@
 
 #include <glm\glm.hpp>
 
-struct UniformFormat {
-	glm::mat4 model;
+// Uniforms that are the same for every draw in a frame
+struct FrameUniforms {
 	glm::mat4 view;
 	glm::mat4 projection;
+	glm::mat4 viewProjection;
 	glm::vec4 cameraPos;
-};
\ No newline at end of file
+	float time;       // Seconds since the program started
+	float padding[3]; // std140 rounds the block up to a whole vec4
+};
+
+// Data for a single object, an element of the Objects storage buffer
+struct ObjectData {
+	glm::mat4 model;
+	glm::mat3x4 normalMatrix; // A mat3 in std430, each column padded to a vec4
+};
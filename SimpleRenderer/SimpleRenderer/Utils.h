@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <random>
 #include <iterator>
@@ -30,6 +31,42 @@ class NDArray : public std::array<NDArray<T, Dims...>, DimFirst> {};
 template <typename T, size_t DimLast>
 class NDArray<T, DimLast> : public std::array<T, DimLast> {};
 
+// A non owning reference to a contiguous sequence of elements
+template <typename T>
+class Span {
+public:
+	Span()
+		: m_data{ nullptr }
+		, m_size{ 0 }
+	{ }
+
+	Span(T* data, size_t size)
+		: m_data{ data }
+		, m_size{ size }
+	{ }
+
+	// Creates a span over a container with contiguous storage (e.g. std::vector)
+	template <typename Container>
+	Span(Container& container)
+		: m_data{ container.data() }
+		, m_size{ container.size() }
+	{ }
+
+	T* begin() const { return m_data; }
+	T* end() const { return m_data + m_size; }
+	T* data() const { return m_data; }
+	size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	T& operator[](size_t i) const { return m_data[i]; }
+
+	// Returns a span over count elements starting at offset
+	Span subspan(size_t offset, size_t count) const { return Span(m_data + offset, count); }
+
+private:
+	T* m_data;
+	size_t m_size;
+};
+
 // Erases an element from a vector in O(1) time without preserving order.
 template <typename Vector>
 typename Vector::iterator unorderedErase(Vector& v, typename Vector::iterator it)
@@ -51,6 +88,17 @@ void unorderedErase(Vector& v, size_t i)
 	v.pop_back();
 }
 
+// Makes room for count more elements without defeating the vector's geometric growth.
+// Reserving exactly size() + count would reallocate on every small batch.
+// Works with any container that has size, capacity and reserve.
+template <typename Vector>
+void reserveMore(Vector& v, size_t count)
+{
+	size_t required = v.size() + count;
+	if (required > v.capacity())
+		v.reserve(std::max(required, 2 * v.capacity()));
+}
+
 // Returns a generator for generating random numbers
 inline std::mt19937& getRandomGenerator()
 {
@@ -14,96 +14,241 @@
 
 #define _USE_MATH_DEFINES
 
+#include "Benchmarks.h"
+#include "CommandBuffer.h"
 #include "GLUtils.h"
 #include "SceneUtils.h"
 #include "InputSystem.h"
+#include "JobSystem.h"
+#include "Memory.h"
 #include "MovementSystem.h"
 #include "RenderSystem.h"
 #include "Scene.h"
+#include "SceneLoader.h"
+#include "SceneSnapshot.h"
 #include "GameplayLogicSystem.h"
+#include "SystemScheduler.h"
+#include "TransformSystem.h"
 
 #include <GLFW\glfw3.h>
 #include <glm\glm.hpp>
 #include <glm\gtc\matrix_transform.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
 
-int main()
+namespace {
+	// The simulation always advances by this many seconds per step, however fast frames are drawn
+	const double kTimeStep = 1.0 / 60.0;
+
+	// Frames longer than this are cut short, so that a stall doesn't leave the
+	// simulation taking ever longer to catch up
+	const double kMaxFrameTime = 0.25;
+
+	// Compaction starts once at least kCompactionMinFreeIDs, and kCompactionFreeFraction
+	// of all entity IDs, belong to destroyed entities.
+	// It moves at most kCompactionMovesPerStep entities each step.
+	const size_t kCompactionMinFreeIDs = 1024;
+	const double kCompactionFreeFraction = 0.25;
+	const size_t kCompactionMovesPerStep = 4096;
+
+	// Returns true if the flag is on the command line
+	bool hasFlag(int argc, char* argv[], const char* flag)
+	{
+		for (int i = 1; i < argc; ++i) {
+			if (std::strcmp(argv[i], flag) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	// Returns the value following the flag on the command line, or nullptr if it isn't there
+	const char* getArgument(int argc, char* argv[], const char* flag)
+	{
+		for (int i = 1; i + 1 < argc; ++i) {
+			if (std::strcmp(argv[i], flag) == 0)
+				return argv[i + 1];
+		}
+		return nullptr;
+	}
+
+	// Renders from the first camera in the scene, using the first cube map as the environment
+	void useFirstCameraAndEnvironment(Scene& scene, RenderSystem& renderSystem)
+	{
+		const EntityView& cameras = scene.view<COMPONENT_CAMERA | COMPONENT_TRANSFORM>();
+		if (cameras.size() > 0)
+			renderSystem.setCamera(cameras.entities().front());
+
+		const SparseSet<MaterialComponent>& materials = scene.materialComponents;
+		for (size_t i = 0; i < materials.size(); ++i) {
+			if (materials.data()[i].textureType == GL_TEXTURE_CUBE_MAP) {
+				renderSystem.setEnvironmentMap(materials.entities()[i]);
+				break;
+			}
+		}
+	}
+}
+
+int main(int argc, char* argv[])
 {
-	GLFWwindow* window = GLUtils::initOpenGL();
+	// Run microbenchmarks instead of the scene when requested
+	if (argc > 1 && std::strcmp(argv[1], "--benchmark-spin") == 0) {
+		Benchmarks::runSpinBenchmark();
+		exit(EXIT_SUCCESS);
+	}
+
+	// Headless runs simulate as fast as possible without drawing.
+	// The window is hidden, but still needed for the context assets are loaded into.
+	bool isHeadless = hasFlag(argc, argv, "--headless");
+	const char* stepsArgument = getArgument(argc, argv, "--steps");
+	size_t maxSteps = stepsArgument ? std::strtoul(stepsArgument, nullptr, 10) : 0;
 
+	GLFWwindow* window = GLUtils::initOpenGL(!isHeadless);
+
+	JobSystem jobSystem;
 	Scene scene;
-	RenderSystem renderSystem(window, scene);
-	MovementSystem movementSystem(scene);
+	CommandBuffer commandBuffer(scene);
+	RenderSystem renderSystem(window, scene, jobSystem);
+	MovementSystem movementSystem(scene, jobSystem);
+	TransformSystem transformSystem(scene);
 	InputSystem inputSystem(window, renderSystem, scene);
-	GameplayLogicSystem gameplayLogicSystem(scene, inputSystem);
-
-	// Order matters, buttons are assigned to the first four entities created
-	SceneUtils::createSphere(scene, glm::translate({}, glm::vec3{ -1.5f, 1.5f, 0 }));
-
-	size_t cubeID = SceneUtils::createCube(scene, 
-		  glm::translate({}, glm::vec3{ 1.5f, 1.5f, 0})
-		* glm::rotate(glm::mat4{}, static_cast<float>(-M_PI / 16), glm::vec3{ 1, 0, 0 }));
-	scene.materialComponents[cubeID].hasOutline = true;
-	scene.materialComponents[cubeID].texture = GLUtils::loadTexture("Assets/Textures/transparent.png");
-	scene.materialComponents[cubeID].isTransparent = true;
-
-	SceneUtils::createCylinder(scene, 1.5, 1.5,
-		  glm::translate(glm::mat4{}, glm::vec3{ -1.5f, -1.5f, 0 })
-		* glm::rotate(glm::mat4{}, static_cast<float>(M_PI / 4), glm::vec3{ 0, 0, 1 }));
-
-	size_t pyramidID = SceneUtils::createPyramid(scene, glm::translate({}, glm::vec3{ 1.5f, -1.5f, 0 }));
-	scene.materialComponents[pyramidID].texture = GLUtils::loadTexture("Assets/Textures/transparent.png");
-	scene.materialComponents[pyramidID].isTransparent = true;
-	
-	size_t waterID = SceneUtils::createQuad(scene, 
-		  glm::translate({}, glm::vec3{ 0, -4.0f, 0 })
-		* glm::rotate({}, static_cast<float>(-M_PI / 2), glm::vec3{ 1, 0, 0 })
-		* glm::scale({}, glm::vec3{ 100, 100, 100 }));
-	scene.materialComponents[waterID].shader = GLUtils::getWaterShader();
-	scene.materialComponents[waterID].isTransparent = true;
-	scene.materialComponents[waterID].shaderParams.metallicness = 0.5;
-	scene.materialComponents[waterID].texture = GLUtils::loadTexture("Assets/Textures/water.png");
-	scene.componentMasks[waterID] &= ~COMPONENT_LOGIC;
-
-	size_t waterFloorID = SceneUtils::createQuad(scene,
-		glm::translate({}, glm::vec3{ 0, -6.0f, 0 })
-		* glm::rotate({}, static_cast<float>(-M_PI / 2), glm::vec3{ 1, 0, 0 })
-		* glm::scale({}, glm::vec3{ 100, 100, 100 }));
-	scene.materialComponents[waterFloorID].shaderParams.metallicness = 0;
-	scene.materialComponents[waterFloorID].texture = GLUtils::loadTexture("Assets/Textures/dessert-floor.png");
-	scene.componentMasks[waterFloorID] &= ~COMPONENT_LOGIC;
-	
-	//SceneUtils::createCube(scene);
-	size_t skybox = SceneUtils::createSkybox(scene, {
-		"Assets/Textures/Skybox/right.jpg",
-		"Assets/Textures/Skybox/left.jpg",
-		"Assets/Textures/Skybox/top.jpg",
-		"Assets/Textures/Skybox/bottom.jpg",
-		"Assets/Textures/Skybox/back.jpg",
-		"Assets/Textures/Skybox/front.jpg",
-	});
-	renderSystem.setEnvironmentMap(skybox);
-
-	size_t cameraEntity = SceneUtils::createCamera(scene, { 0, 0, 6 }, { 0, 0, 0 }, { 0, 1, 0 });
-	renderSystem.setCamera(cameraEntity);
+	GameplayLogicSystem gameplayLogicSystem(scene, inputSystem, jobSystem, commandBuffer);
+
+	// Systems that use the same components run in the order they are added,
+	// all other systems run at the same time.
+	SystemScheduler scheduler(scene, jobSystem);
+	scheduler.addSystem(gameplayLogicSystem);
+	scheduler.addSystem(inputSystem);
+	scheduler.addSystem(movementSystem);
+	scheduler.addSystem(transformSystem);
+
+	// The render system isn't scheduled, as its state is only extracted once
+	// per frame, after however many steps the frame simulates
+
+	// Build the scene from a snapshot if one was given, otherwise from a scene description
+	const char* snapshotToLoad = getArgument(argc, argv, "--load-snapshot");
+	const char* sceneToLoad = getArgument(argc, argv, "--scene");
+	if (snapshotToLoad)
+		SceneSnapshot::load(scene, snapshotToLoad);
+	else
+		SceneLoader::load(scene, sceneToLoad ? sceneToLoad : "Assets/Scenes/default.scene", jobSystem);
+	useFirstCameraAndEnvironment(scene, renderSystem);
 
+	const char* snapshotToSave = getArgument(argc, argv, "--save-snapshot");
+	if (snapshotToSave)
+		SceneSnapshot::save(scene, snapshotToSave);
+
+	// Advances the simulation by a single step
+	bool isCompacting = false;
+	auto simulateStep = [&]() {
+		// Possession changes are applied before any system runs, 
+		// so the newly possessed entity responds to input this step.
+		gameplayLogicSystem.beginFrame();
+
+		// Structural changes recorded since the last step are applied
+		// here, while no system is iterating over the entities
+		commandBuffer.flush();
+
+		// After mass destruction, move live entities down into the freed IDs
+		// a few at a time, then shrink the scene
+		size_t numFreeIDs = scene.freeEntityIDs.size();
+		if (isCompacting || (numFreeIDs >= kCompactionMinFreeIDs && numFreeIDs > kCompactionFreeFraction * SceneUtils::getEntityCount(scene))) {
+			SceneUtils::CompactionResult compaction = SceneUtils::compactEntities(scene, kCompactionMovesPerStep);
+			isCompacting = !compaction.isComplete;
+			if (compaction.isComplete)
+				std::cout << "Compacted scene, reclaimed " << compaction.bytesReclaimed << " bytes" << std::endl;
+		}
+
+		scheduler.run();
+		inputSystem.endStep();
+	};
+
+	if (isHeadless) {
+		// Step until the requested number of steps, or forever if none was given,
+		// reporting the throughput every second
+		size_t numSteps = 0;
+		size_t reportSteps = 0;
+		double reportTime = glfwGetTime();
+		while (maxSteps == 0 || numSteps < maxSteps) {
+			simulateStep();
+			SceneUtils::advanceFrame(scene);
+			++numSteps;
+
+			double time = glfwGetTime();
+			if (time - reportTime >= 1.0 || numSteps == maxSteps) {
+				std::cout << numSteps << " steps, " << (numSteps - reportSteps) / (time - reportTime) << " steps/s" << std::endl;
+				Memory::printStats(std::cout);
+				reportSteps = numSteps;
+				reportTime = time;
+			}
+		}
+
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		exit(EXIT_SUCCESS);
+	}
+
+	double previousTime = glfwGetTime();
+	double unsimulatedTime = 0;
+	size_t reportFrames = 0;
+	double reportTime = previousTime;
 	while (!glfwWindowShouldClose(window)) {
+		double time = glfwGetTime();
+		unsimulatedTime += std::min(time - previousTime, kMaxFrameTime);
+		previousTime = time;
+
 		inputSystem.beginFrame();
-		renderSystem.beginRender();
 
-		for (size_t entityID = 0; entityID < SceneUtils::getEntityCount(scene); ++entityID) {
-			gameplayLogicSystem.update(entityID);
-			inputSystem.update(entityID);
-			movementSystem.update(entityID);
-			renderSystem.update(entityID);
+		// Take as many whole steps as fit in the time that has passed.
+		// The remainder is carried to the next frame, and is how far the
+		// objects are drawn between the last two steps.
+		int numSteps = static_cast<int>(unsimulatedTime / kTimeStep);
+		unsimulatedTime -= numSteps * kTimeStep;
+		float interpolation = static_cast<float>(unsimulatedTime / kTimeStep);
+
+		// Simulate this frame on the workers while the main thread draws the
+		// state extracted last frame. None of the scheduled systems are main
+		// thread only, so the scheduler can run from a job.
+		JobGroup simulation;
+		jobSystem.submit(simulation, [&, numSteps, interpolation]() {
+			for (int i = 0; i < numSteps; ++i)
+				simulateStep();
+
+			// The state is extracted even without a step, as the interpolation has moved on
+			renderSystem.setInterpolation(interpolation);
+			renderSystem.update(scene.view<RenderSystem::kComponentMask>().entities());
+		});
+		renderSystem.render();
+		jobSystem.wait(simulation);
+
+		// The state extracted by this frame's simulation is drawn next frame
+		renderSystem.swapRenderStates();
+
+		// Show the frame rate and what the last frame cost in the title, every second
+		++reportFrames;
+		if (time - reportTime >= 1.0) {
+			const RenderStats& stats = renderSystem.getStats();
+			std::ostringstream title;
+			title << "Simple Renderer - " << static_cast<int>(reportFrames / (time - reportTime)) << " fps, "
+			      << stats.numInstances << " objects, " << stats.numCommands << " meshes in " << stats.numDraws << " draws, " << stats.numStateChanges << " state changes ("
+			      << stats.numStateChangesSaved << " saved)";
+			glfwSetWindowTitle(window, title.str().c_str());
+			reportFrames = 0;
+			reportTime = time;
 		}
-		
-		renderSystem.endRender();
-		
+
+		// Changes made by input callbacks belong to the next frame
+		SceneUtils::advanceFrame(scene);
 		glfwPollEvents();
 	}
 
+	// Heap allocations should stop growing once the scene reaches a steady state
+	Memory::printStats(std::cout);
+
 	glfwDestroyWindow(window);
 	glfwTerminate();
 	exit(EXIT_SUCCESS);